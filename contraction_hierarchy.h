@@ -0,0 +1,567 @@
+#pragma once
+
+#include "router.h"
+
+#include <functional>
+#include <queue>
+#include <tuple>
+
+namespace graph
+{
+
+    template <typename Weight, typename Graph = CsrGraph<Weight>>
+    class ContractionHierarchy final : public RouterBase<Weight>
+    {
+    private:
+        using SearchGraph = CsrGraph<Weight>;
+
+    public:
+        using typename RouterBase<Weight>::RouteInfo;
+
+        // Shortcut replaces the path first -> second. Arc ids below GetEdgeCount() of the graph are
+        // original edges, the others are shortcuts in the order they were created.
+        struct Shortcut
+        {
+            EdgeId first;
+            EdgeId second;
+        };
+
+        explicit ContractionHierarchy(const Graph &graph);
+        ContractionHierarchy(const Graph &graph, std::vector<size_t> ranks, std::vector<Shortcut> shortcuts);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+        const std::vector<size_t> &GetRanks() const;
+
+        const std::vector<Shortcut> &GetShortcuts() const;
+
+    private:
+        struct QueueItem
+        {
+            Weight weight;
+            VertexId vertex;
+
+            bool operator>(const QueueItem &other) const
+            {
+                return weight > other.weight;
+            }
+        };
+        using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+        struct Neighbour
+        {
+            VertexId vertex;
+            Weight weight;
+            EdgeId arc;
+        };
+
+        class WitnessSearch;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        static constexpr size_t WITNESS_SETTLED_LIMIT = 500;
+
+        const Graph &graph_;
+        std::vector<size_t> ranks_;
+        std::vector<Shortcut> shortcuts_;
+        std::vector<Edge<Weight>> shortcut_edges_;
+        // upward_ keeps arcs to higher ranked vertices, downward_ keeps reversed arcs from higher ranked vertices
+        SearchGraph upward_;
+        SearchGraph downward_;
+        std::vector<EdgeId> upward_arcs_;
+        std::vector<EdgeId> downward_arcs_;
+
+        Edge<Weight> GetArc(EdgeId arc) const;
+
+        void AddShortcut(const Shortcut &shortcut);
+
+        void Contract();
+
+        void BuildSearchGraphs();
+
+        void UnpackArc(EdgeId arc, std::vector<EdgeId> &edges) const;
+
+        static std::vector<Neighbour> CollectNeighbours(const std::vector<EdgeId> &arcs, const std::vector<Edge<Weight>> &arc_data,
+                                                        bool incoming);
+    };
+
+    // Dijkstra limited by distance and by the number of settled vertices, reused between contractions.
+    // It stops as soon as every target is reached not heavier than the path through the contracted vertex.
+    template <typename Weight, typename Graph>
+    class ContractionHierarchy<Weight, Graph>::WitnessSearch
+    {
+    public:
+        explicit WitnessSearch(size_t vertex_count)
+            : weights_(vertex_count, ZERO_WEIGHT), visited_(vertex_count, 0), targets_(vertex_count, 0), target_weights_(vertex_count, ZERO_WEIGHT)
+        {
+        }
+
+        template <typename OutgoingArcs>
+        void Run(const Neighbour &source, VertexId excluded, const std::vector<Neighbour> &targets, const OutgoingArcs &outgoing_arcs)
+        {
+            ++generation_;
+            targets_left_ = 0;
+            Weight max_weight = ZERO_WEIGHT;
+            for (const Neighbour &target : targets)
+            {
+                if (target.vertex != source.vertex)
+                {
+                    targets_[target.vertex] = generation_;
+                    target_weights_[target.vertex] = source.weight + target.weight;
+                    max_weight = std::max(max_weight, target_weights_[target.vertex]);
+                    ++targets_left_;
+                }
+            }
+
+            Queue queue;
+            Reach(source.vertex, ZERO_WEIGHT);
+            queue.push({ZERO_WEIGHT, source.vertex});
+            size_t settled = 0;
+            while (!queue.empty() && settled < WITNESS_SETTLED_LIMIT && targets_left_ > 0)
+            {
+                const QueueItem item = queue.top();
+                queue.pop();
+                if (item.weight > weights_[item.vertex])
+                {
+                    continue;
+                }
+                if (item.weight > max_weight)
+                {
+                    break;
+                }
+                ++settled;
+                outgoing_arcs(item.vertex, [&](VertexId to, Weight weight)
+                              {
+                                  if (to == excluded)
+                                  {
+                                      return;
+                                  }
+                                  const Weight candidate_weight = item.weight + weight;
+                                  if (!IsReached(to) || candidate_weight < weights_[to])
+                                  {
+                                      Reach(to, candidate_weight);
+                                      queue.push({candidate_weight, to});
+                                  }
+                              });
+            }
+        }
+
+        bool IsReached(VertexId vertex) const
+        {
+            return visited_[vertex] == generation_;
+        }
+
+        Weight GetWeight(VertexId vertex) const
+        {
+            return weights_[vertex];
+        }
+
+    private:
+        std::vector<Weight> weights_;
+        std::vector<size_t> visited_;
+        std::vector<size_t> targets_;
+        std::vector<Weight> target_weights_;
+        size_t generation_ = 0;
+        size_t targets_left_ = 0;
+
+        void Reach(VertexId vertex, Weight weight)
+        {
+            const bool was_witnessed = IsReached(vertex) && !(target_weights_[vertex] < weights_[vertex]);
+            visited_[vertex] = generation_;
+            weights_[vertex] = weight;
+            if (targets_[vertex] == generation_ && !was_witnessed && !(target_weights_[vertex] < weight))
+            {
+                --targets_left_;
+            }
+        }
+    };
+
+    template <typename Weight, typename Graph>
+    ContractionHierarchy<Weight, Graph>::ContractionHierarchy(const Graph &graph)
+        : graph_(graph), ranks_(graph.GetVertexCount())
+    {
+        for (VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex)
+        {
+            graph.ForEachIncidentEdge(vertex, [](EdgeId, VertexId, Weight weight)
+                                      {
+                                          if (weight < ZERO_WEIGHT)
+                                          {
+                                              throw std::domain_error("Edges' weights should be non-negative");
+                                          }
+                                      });
+        }
+        Contract();
+        BuildSearchGraphs();
+    }
+
+    template <typename Weight, typename Graph>
+    ContractionHierarchy<Weight, Graph>::ContractionHierarchy(const Graph &graph, std::vector<size_t> ranks, std::vector<Shortcut> shortcuts)
+        : graph_(graph), ranks_(std::move(ranks))
+    {
+        if (ranks_.size() != graph.GetVertexCount())
+        {
+            throw std::invalid_argument("Contraction hierarchy does not match the graph");
+        }
+        shortcuts_.reserve(shortcuts.size());
+        shortcut_edges_.reserve(shortcuts.size());
+        for (const Shortcut &shortcut : shortcuts)
+        {
+            if (shortcut.first >= graph.GetEdgeCount() + shortcuts_.size() || shortcut.second >= graph.GetEdgeCount() + shortcuts_.size())
+            {
+                throw std::invalid_argument("Contraction hierarchy does not match the graph");
+            }
+            AddShortcut(shortcut);
+        }
+        BuildSearchGraphs();
+    }
+
+    template <typename Weight, typename Graph>
+    std::optional<typename ContractionHierarchy<Weight, Graph>::RouteInfo> ContractionHierarchy<Weight, Graph>::BuildRoute(VertexId from,
+                                                                                                                           VertexId to) const
+    {
+        const size_t vertex_count = graph_.GetVertexCount();
+        if (from >= vertex_count || to >= vertex_count)
+        {
+            throw std::out_of_range("Vertex is out of range");
+        }
+
+        // index 0 - forward search over upward_, index 1 - backward search over downward_
+        const SearchGraph *search_graphs[2] = {&upward_, &downward_};
+        std::vector<Weight> weights[2] = {std::vector<Weight>(vertex_count, ZERO_WEIGHT), std::vector<Weight>(vertex_count, ZERO_WEIGHT)};
+        std::vector<std::optional<EdgeId>> prev_edges[2] = {std::vector<std::optional<EdgeId>>(vertex_count),
+                                                            std::vector<std::optional<EdgeId>>(vertex_count)};
+        std::vector<bool> reached[2] = {std::vector<bool>(vertex_count, false), std::vector<bool>(vertex_count, false)};
+        Queue queues[2];
+
+        reached[0][from] = true;
+        queues[0].push({ZERO_WEIGHT, from});
+        reached[1][to] = true;
+        queues[1].push({ZERO_WEIGHT, to});
+
+        std::optional<Weight> best_weight;
+        VertexId meeting_vertex = from;
+        while (!queues[0].empty() || !queues[1].empty())
+        {
+            const size_t side = queues[1].empty() || (!queues[0].empty() && queues[0].top().weight <= queues[1].top().weight) ? 0 : 1;
+            const QueueItem item = queues[side].top();
+            queues[side].pop();
+            if (best_weight && !(item.weight < *best_weight))
+            {
+                break;
+            }
+            if (item.weight > weights[side][item.vertex])
+            {
+                continue;
+            }
+            if (reached[1 - side][item.vertex])
+            {
+                const Weight candidate_weight = item.weight + weights[1 - side][item.vertex];
+                if (!best_weight || candidate_weight < *best_weight)
+                {
+                    best_weight = candidate_weight;
+                    meeting_vertex = item.vertex;
+                }
+            }
+            // stall-on-demand: a higher ranked vertex already reaches this one cheaper, so its weight is not final
+            bool stalled = false;
+            search_graphs[1 - side]->ForEachIncidentEdge(item.vertex, [&](EdgeId, VertexId edge_to, Weight edge_weight)
+                                                         {
+                                                             if (reached[side][edge_to] && weights[side][edge_to] + edge_weight < item.weight)
+                                                             {
+                                                                 stalled = true;
+                                                             }
+                                                         });
+            if (stalled)
+            {
+                continue;
+            }
+            search_graphs[side]->ForEachIncidentEdge(item.vertex, [&](EdgeId edge_id, VertexId edge_to, Weight edge_weight)
+                                                     {
+                                                         const Weight candidate_weight = item.weight + edge_weight;
+                                                         if (!reached[side][edge_to] || candidate_weight < weights[side][edge_to])
+                                                         {
+                                                             reached[side][edge_to] = true;
+                                                             weights[side][edge_to] = candidate_weight;
+                                                             prev_edges[side][edge_to] = edge_id;
+                                                             queues[side].push({candidate_weight, edge_to});
+                                                         }
+                                                     });
+        }
+
+        if (!best_weight)
+        {
+            return std::nullopt;
+        }
+
+        std::vector<EdgeId> arcs;
+        for (VertexId vertex = meeting_vertex; prev_edges[0][vertex];)
+        {
+            const EdgeId edge_id = *prev_edges[0][vertex];
+            arcs.push_back(upward_arcs_[edge_id]);
+            vertex = upward_.GetEdge(edge_id).from;
+        }
+        std::reverse(arcs.begin(), arcs.end());
+        for (VertexId vertex = meeting_vertex; prev_edges[1][vertex];)
+        {
+            const EdgeId edge_id = *prev_edges[1][vertex];
+            arcs.push_back(downward_arcs_[edge_id]);
+            vertex = downward_.GetEdge(edge_id).from;
+        }
+
+        std::vector<EdgeId> edges;
+        for (const EdgeId arc : arcs)
+        {
+            UnpackArc(arc, edges);
+        }
+        return RouteInfo{*best_weight, std::move(edges)};
+    }
+
+    template <typename Weight, typename Graph>
+    const std::vector<size_t> &ContractionHierarchy<Weight, Graph>::GetRanks() const
+    {
+        return ranks_;
+    }
+
+    template <typename Weight, typename Graph>
+    const std::vector<typename ContractionHierarchy<Weight, Graph>::Shortcut> &ContractionHierarchy<Weight, Graph>::GetShortcuts() const
+    {
+        return shortcuts_;
+    }
+
+    template <typename Weight, typename Graph>
+    Edge<Weight> ContractionHierarchy<Weight, Graph>::GetArc(EdgeId arc) const
+    {
+        if (arc < graph_.GetEdgeCount())
+        {
+            return graph_.GetEdge(arc);
+        }
+        return shortcut_edges_[arc - graph_.GetEdgeCount()];
+    }
+
+    template <typename Weight, typename Graph>
+    void ContractionHierarchy<Weight, Graph>::AddShortcut(const Shortcut &shortcut)
+    {
+        const Edge<Weight> first = GetArc(shortcut.first);
+        const Edge<Weight> second = GetArc(shortcut.second);
+        shortcuts_.push_back(shortcut);
+        shortcut_edges_.push_back({first.from, second.to, first.weight + second.weight});
+    }
+
+    template <typename Weight, typename Graph>
+    void ContractionHierarchy<Weight, Graph>::Contract()
+    {
+        const size_t vertex_count = graph_.GetVertexCount();
+        std::vector<Edge<Weight>> arc_data;
+        arc_data.reserve(graph_.GetEdgeCount());
+        // only the lightest arc between two not yet contracted vertices is kept
+        std::vector<std::vector<EdgeId>> out_arcs(vertex_count);
+        std::vector<std::vector<EdgeId>> in_arcs(vertex_count);
+        auto insert_arc = [&arc_data](std::vector<EdgeId> &arcs, EdgeId arc, bool incoming)
+        {
+            const Edge<Weight> &edge = arc_data[arc];
+            for (EdgeId &other : arcs)
+            {
+                const Edge<Weight> &other_edge = arc_data[other];
+                if ((incoming ? other_edge.from == edge.from : other_edge.to == edge.to))
+                {
+                    if (edge.weight < other_edge.weight)
+                    {
+                        other = arc;
+                    }
+                    return;
+                }
+            }
+            arcs.push_back(arc);
+        };
+        auto add_arc = [&](const Edge<Weight> &edge)
+        {
+            const EdgeId arc = arc_data.size();
+            arc_data.push_back(edge);
+            if (edge.from != edge.to)
+            {
+                insert_arc(out_arcs[edge.from], arc, false);
+                insert_arc(in_arcs[edge.to], arc, true);
+            }
+        };
+        arc_data.resize(graph_.GetEdgeCount());
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex)
+        {
+            graph_.ForEachIncidentEdge(vertex, [&arc_data, vertex](EdgeId edge_id, VertexId to, Weight weight)
+                                       { arc_data[edge_id] = {vertex, to, weight}; });
+        }
+        for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id)
+        {
+            const Edge<Weight> edge = arc_data[edge_id];
+            if (edge.from != edge.to)
+            {
+                insert_arc(out_arcs[edge.from], edge_id, false);
+                insert_arc(in_arcs[edge.to], edge_id, true);
+            }
+        }
+
+        std::vector<int> contracted_neighbours(vertex_count, 0);
+        WitnessSearch witness_search(vertex_count);
+        auto outgoing_arcs = [&](VertexId vertex, const auto &relax)
+        {
+            for (const EdgeId arc : out_arcs[vertex])
+            {
+                relax(arc_data[arc].to, arc_data[arc].weight);
+            }
+        };
+
+        // Finds the shortcuts needed to contract the vertex; they are created only when add is set
+        auto process_vertex = [&](VertexId vertex, bool add)
+        {
+            const std::vector<Neighbour> incoming = CollectNeighbours(in_arcs[vertex], arc_data, true);
+            const std::vector<Neighbour> outgoing = CollectNeighbours(out_arcs[vertex], arc_data, false);
+            int shortcut_count = 0;
+            if (outgoing.empty())
+            {
+                return shortcut_count - static_cast<int>(incoming.size());
+            }
+            for (const Neighbour &in : incoming)
+            {
+                witness_search.Run(in, vertex, outgoing, outgoing_arcs);
+                for (const Neighbour &out : outgoing)
+                {
+                    if (out.vertex == in.vertex)
+                    {
+                        continue;
+                    }
+                    const Weight via_weight = in.weight + out.weight;
+                    if (witness_search.IsReached(out.vertex) && !(via_weight < witness_search.GetWeight(out.vertex)))
+                    {
+                        continue;
+                    }
+                    ++shortcut_count;
+                    if (add)
+                    {
+                        AddShortcut({in.arc, out.arc});
+                        add_arc(shortcut_edges_.back());
+                    }
+                }
+            }
+            return shortcut_count - static_cast<int>(incoming.size() + outgoing.size());
+        };
+
+        auto priority = [&](VertexId vertex)
+        {
+            return process_vertex(vertex, false) + contracted_neighbours[vertex];
+        };
+
+        using PriorityItem = std::pair<int, VertexId>;
+        std::priority_queue<PriorityItem, std::vector<PriorityItem>, std::greater<PriorityItem>> order;
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex)
+        {
+            order.push({priority(vertex), vertex});
+        }
+
+        size_t rank = 0;
+        while (!order.empty())
+        {
+            const VertexId vertex = order.top().second;
+            order.pop();
+            const int current_priority = priority(vertex);
+            if (!order.empty() && current_priority > order.top().first)
+            {
+                order.push({current_priority, vertex});
+                continue;
+            }
+
+            process_vertex(vertex, true);
+            ranks_[vertex] = rank++;
+            for (const EdgeId arc : in_arcs[vertex])
+            {
+                const VertexId neighbour = arc_data[arc].from;
+                auto &arcs = out_arcs[neighbour];
+                arcs.erase(std::find(arcs.begin(), arcs.end(), arc));
+                ++contracted_neighbours[neighbour];
+            }
+            for (const EdgeId arc : out_arcs[vertex])
+            {
+                const VertexId neighbour = arc_data[arc].to;
+                auto &arcs = in_arcs[neighbour];
+                arcs.erase(std::find(arcs.begin(), arcs.end(), arc));
+                ++contracted_neighbours[neighbour];
+            }
+            in_arcs[vertex].clear();
+            in_arcs[vertex].shrink_to_fit();
+            out_arcs[vertex].clear();
+            out_arcs[vertex].shrink_to_fit();
+        }
+    }
+
+    template <typename Weight, typename Graph>
+    void ContractionHierarchy<Weight, Graph>::BuildSearchGraphs()
+    {
+        const size_t vertex_count = graph_.GetVertexCount();
+        // for every direction only the lightest of the parallel arcs can be a part of a shortest path
+        std::vector<std::pair<Edge<Weight>, EdgeId>> upward_arcs;
+        std::vector<std::pair<Edge<Weight>, EdgeId>> downward_arcs;
+        for (EdgeId arc = 0; arc < graph_.GetEdgeCount() + shortcuts_.size(); ++arc)
+        {
+            const Edge<Weight> edge = GetArc(arc);
+            if (ranks_[edge.from] < ranks_[edge.to])
+            {
+                upward_arcs.push_back({edge, arc});
+            }
+            else if (ranks_[edge.from] > ranks_[edge.to])
+            {
+                downward_arcs.push_back({{edge.to, edge.from, edge.weight}, arc});
+            }
+        }
+        auto fill = [vertex_count](std::vector<std::pair<Edge<Weight>, EdgeId>> &arcs, SearchGraph &search_graph, std::vector<EdgeId> &arc_ids)
+        {
+            std::sort(arcs.begin(), arcs.end(), [](const auto &lhs, const auto &rhs)
+                      { return std::tie(lhs.first.from, lhs.first.to, lhs.first.weight, lhs.second) <
+                               std::tie(rhs.first.from, rhs.first.to, rhs.first.weight, rhs.second); });
+            arcs.erase(std::unique(arcs.begin(), arcs.end(), [](const auto &lhs, const auto &rhs)
+                                   { return lhs.first.from == rhs.first.from && lhs.first.to == rhs.first.to; }),
+                       arcs.end());
+            DirectedWeightedGraph<Weight> graph(vertex_count);
+            arc_ids.clear();
+            arc_ids.reserve(arcs.size());
+            for (const auto &[edge, arc] : arcs)
+            {
+                graph.AddEdge(edge);
+                arc_ids.push_back(arc);
+            }
+            search_graph = SearchGraph(graph);
+        };
+        fill(upward_arcs, upward_, upward_arcs_);
+        fill(downward_arcs, downward_, downward_arcs_);
+    }
+
+    template <typename Weight, typename Graph>
+    void ContractionHierarchy<Weight, Graph>::UnpackArc(EdgeId arc, std::vector<EdgeId> &edges) const
+    {
+        std::vector<EdgeId> stack{arc};
+        while (!stack.empty())
+        {
+            const EdgeId current = stack.back();
+            stack.pop_back();
+            if (current < graph_.GetEdgeCount())
+            {
+                edges.push_back(current);
+                continue;
+            }
+            const Shortcut &shortcut = shortcuts_[current - graph_.GetEdgeCount()];
+            stack.push_back(shortcut.second);
+            stack.push_back(shortcut.first);
+        }
+    }
+
+    template <typename Weight, typename Graph>
+    std::vector<typename ContractionHierarchy<Weight, Graph>::Neighbour> ContractionHierarchy<Weight, Graph>::CollectNeighbours(
+        const std::vector<EdgeId> &arcs, const std::vector<Edge<Weight>> &arc_data, bool incoming)
+    {
+        std::vector<Neighbour> neighbours;
+        neighbours.reserve(arcs.size());
+        for (const EdgeId arc : arcs)
+        {
+            const auto &edge = arc_data[arc];
+            neighbours.push_back({incoming ? edge.from : edge.to, edge.weight, arc});
+        }
+        return neighbours;
+    }
+
+} // namespace graph
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "graph.h"
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+namespace graph
+{
+
+    // Frozen compressed sparse row copy of DirectedWeightedGraph. Edges keep their ids, but are laid out
+    // grouped by the source vertex in parallel arrays, so a scan of the incident edges is sequential.
+    // The arrays are either owned by the graph or laid out elsewhere, e.g. in a mapped base file
+    template <typename Weight>
+    class CsrGraph
+    {
+    public:
+        using EdgeIndex = uint32_t;
+
+        // offsets - vertex_count + 1 items, the others - edge_count items
+        struct Arrays
+        {
+            size_t vertex_count = 0;
+            size_t edge_count = 0;
+            const EdgeIndex *offsets = nullptr;
+            const EdgeIndex *sources = nullptr;
+            const EdgeIndex *targets = nullptr;
+            const Weight *weights = nullptr;
+            const EdgeIndex *edge_ids = nullptr;
+            const EdgeIndex *positions = nullptr;
+        };
+
+    private:
+        using IncidentEdgesRange = ranges::Range<const EdgeIndex *>;
+
+    public:
+        CsrGraph() = default;
+        // The weights may be narrowed, e.g. to build a float routes table from a double graph
+        template <typename GraphWeight>
+        explicit CsrGraph(const DirectedWeightedGraph<GraphWeight> &graph);
+        // The id of an edge is its index, the layout is the same as the one of the graph the edges were added to in turn
+        CsrGraph(size_t vertex_count, const std::vector<Edge<Weight>> &edges);
+        // The arrays are not copied and have to outlive the graph
+        explicit CsrGraph(const Arrays &arrays);
+
+        // Routers refer to the graph, a copy would not be the graph they were built for
+        CsrGraph(const CsrGraph &) = delete;
+        CsrGraph &operator=(const CsrGraph &) = delete;
+        CsrGraph(CsrGraph &&) = default;
+        CsrGraph &operator=(CsrGraph &&) = default;
+
+        size_t GetVertexCount() const;
+        size_t GetEdgeCount() const;
+        Edge<Weight> GetEdge(EdgeId edge_id) const;
+        IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
+
+        // callback(EdgeId edge_id, VertexId to, Weight weight) is called for every edge going out of the vertex
+        template <typename Callback>
+        void ForEachIncidentEdge(VertexId vertex, Callback callback) const;
+
+        const Arrays &GetArrays() const;
+
+    private:
+        // empty for a graph over the arrays of someone else
+        std::vector<EdgeIndex> offsets_;
+        // the vertex an edge goes out of by its position, so an edge is got by its id without a search over the offsets
+        std::vector<EdgeIndex> sources_;
+        std::vector<EdgeIndex> targets_;
+        std::vector<Weight> weights_;
+        std::vector<EdgeIndex> edge_ids_;
+        std::vector<EdgeIndex> positions_;
+        // a moved vector keeps its buffer, so the pointers stay valid when the graph is moved
+        Arrays arrays_;
+    };
+
+    template <typename Weight>
+    template <typename GraphWeight>
+    CsrGraph<Weight>::CsrGraph(const DirectedWeightedGraph<GraphWeight> &graph)
+        : offsets_(graph.GetVertexCount() + 1, 0)
+    {
+        const size_t edge_count = graph.GetEdgeCount();
+        if (edge_count >= std::numeric_limits<EdgeIndex>::max() || graph.GetVertexCount() >= std::numeric_limits<EdgeIndex>::max())
+        {
+            throw std::length_error("Graph is too large for CsrGraph");
+        }
+        sources_.reserve(edge_count);
+        targets_.reserve(edge_count);
+        weights_.reserve(edge_count);
+        edge_ids_.reserve(edge_count);
+        positions_.resize(edge_count);
+        for (VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex)
+        {
+            for (const EdgeId edge_id : graph.GetIncidentEdges(vertex))
+            {
+                const auto &edge = graph.GetEdge(edge_id);
+                positions_[edge_id] = targets_.size();
+                sources_.push_back(vertex);
+                targets_.push_back(edge.to);
+                weights_.push_back(static_cast<Weight>(edge.weight));
+                edge_ids_.push_back(edge_id);
+            }
+            offsets_[vertex + 1] = targets_.size();
+        }
+        arrays_ = {graph.GetVertexCount(), edge_count, offsets_.data(), sources_.data(), targets_.data(), weights_.data(), edge_ids_.data(), positions_.data()};
+    }
+
+    template <typename Weight>
+    CsrGraph<Weight>::CsrGraph(size_t vertex_count, const std::vector<Edge<Weight>> &edges)
+        : offsets_(vertex_count + 1, 0), sources_(edges.size()), targets_(edges.size()), weights_(edges.size()), edge_ids_(edges.size()), positions_(edges.size())
+    {
+        if (edges.size() >= std::numeric_limits<EdgeIndex>::max() || vertex_count >= std::numeric_limits<EdgeIndex>::max())
+        {
+            throw std::length_error("Graph is too large for CsrGraph");
+        }
+        for (const Edge<Weight> &edge : edges)
+        {
+            ++offsets_.at(edge.from + 1);
+        }
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex)
+        {
+            offsets_[vertex + 1] += offsets_[vertex];
+        }
+        // the edges of a vertex are placed in the order of their ids
+        std::vector<EdgeIndex> next_positions(offsets_.begin(), offsets_.end() - 1);
+        for (EdgeId edge_id = 0; edge_id < edges.size(); ++edge_id)
+        {
+            const EdgeIndex position = next_positions[edges[edge_id].from]++;
+            sources_[position] = edges[edge_id].from;
+            targets_[position] = edges[edge_id].to;
+            weights_[position] = edges[edge_id].weight;
+            edge_ids_[position] = edge_id;
+            positions_[edge_id] = position;
+        }
+        arrays_ = {vertex_count, edges.size(), offsets_.data(), sources_.data(), targets_.data(), weights_.data(), edge_ids_.data(), positions_.data()};
+    }
+
+    template <typename Weight>
+    CsrGraph<Weight>::CsrGraph(const Arrays &arrays)
+        : arrays_(arrays)
+    {
+    }
+
+    template <typename Weight>
+    size_t CsrGraph<Weight>::GetVertexCount() const
+    {
+        return arrays_.vertex_count;
+    }
+
+    template <typename Weight>
+    size_t CsrGraph<Weight>::GetEdgeCount() const
+    {
+        return arrays_.edge_count;
+    }
+
+    template <typename Weight>
+    Edge<Weight> CsrGraph<Weight>::GetEdge(EdgeId edge_id) const
+    {
+        if (edge_id >= arrays_.edge_count)
+        {
+            throw std::out_of_range("Edge is out of range");
+        }
+        const EdgeIndex position = arrays_.positions[edge_id];
+        return {arrays_.sources[position], arrays_.targets[position], arrays_.weights[position]};
+    }
+
+    template <typename Weight>
+    typename CsrGraph<Weight>::IncidentEdgesRange CsrGraph<Weight>::GetIncidentEdges(VertexId vertex) const
+    {
+        if (vertex >= arrays_.vertex_count)
+        {
+            throw std::out_of_range("Vertex is out of range");
+        }
+        return {arrays_.edge_ids + arrays_.offsets[vertex], arrays_.edge_ids + arrays_.offsets[vertex + 1]};
+    }
+
+    template <typename Weight>
+    template <typename Callback>
+    void CsrGraph<Weight>::ForEachIncidentEdge(VertexId vertex, Callback callback) const
+    {
+        for (EdgeIndex position = arrays_.offsets[vertex]; position < arrays_.offsets[vertex + 1]; ++position)
+        {
+            callback(arrays_.edge_ids[position], arrays_.targets[position], arrays_.weights[position]);
+        }
+    }
+
+    template <typename Weight>
+    const typename CsrGraph<Weight>::Arrays &CsrGraph<Weight>::GetArrays() const
+    {
+        return arrays_;
+    }
+
+} // namespace graph
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "router.h"
+
+#include <functional>
+#include <queue>
+
+namespace graph
+{
+
+    template <typename Weight, typename Graph = CsrGraph<Weight>>
+    class DijkstraRouter final : public RouterBase<Weight>
+    {
+    public:
+        using typename RouterBase<Weight>::RouteInfo;
+
+        explicit DijkstraRouter(const Graph &graph);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+        // One search from the vertex, stopped when every target is settled
+        std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId> &to) const override;
+
+        bool SharesSearches() const override
+        {
+            return true;
+        }
+
+    private:
+        struct SearchTree
+        {
+            std::vector<Weight> weights;
+            std::vector<std::optional<EdgeId>> prev_edges;
+            std::vector<bool> reached;
+        };
+
+        struct QueueItem
+        {
+            Weight weight;
+            VertexId vertex;
+
+            bool operator>(const QueueItem &other) const
+            {
+                return weight > other.weight;
+            }
+        };
+        using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        const Graph &graph_;
+
+        SearchTree Search(VertexId from, const std::vector<VertexId> &targets) const;
+
+        std::optional<RouteInfo> ExtractRoute(const SearchTree &search_tree, VertexId to) const;
+    };
+
+    template <typename Weight, typename Graph>
+    DijkstraRouter<Weight, Graph>::DijkstraRouter(const Graph &graph)
+        : graph_(graph)
+    {
+        for (VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex)
+        {
+            graph.ForEachIncidentEdge(vertex, [](EdgeId, VertexId, Weight weight)
+                                      {
+                                          if (weight < ZERO_WEIGHT)
+                                          {
+                                              throw std::domain_error("Edges' weights should be non-negative");
+                                          }
+                                      });
+        }
+    }
+
+    template <typename Weight, typename Graph>
+    std::optional<typename DijkstraRouter<Weight, Graph>::RouteInfo> DijkstraRouter<Weight, Graph>::BuildRoute(VertexId from,
+                                                                                                               VertexId to) const
+    {
+        return ExtractRoute(Search(from, {to}), to);
+    }
+
+    template <typename Weight, typename Graph>
+    std::vector<std::optional<typename DijkstraRouter<Weight, Graph>::RouteInfo>> DijkstraRouter<Weight, Graph>::BuildRoutes(
+        VertexId from, const std::vector<VertexId> &to) const
+    {
+        const SearchTree search_tree = Search(from, to);
+        std::vector<std::optional<RouteInfo>> routes;
+        routes.reserve(to.size());
+        for (const VertexId vertex : to)
+        {
+            routes.push_back(ExtractRoute(search_tree, vertex));
+        }
+        return routes;
+    }
+
+    template <typename Weight, typename Graph>
+    typename DijkstraRouter<Weight, Graph>::SearchTree DijkstraRouter<Weight, Graph>::Search(VertexId from,
+                                                                                            const std::vector<VertexId> &targets) const
+    {
+        const size_t vertex_count = graph_.GetVertexCount();
+        if (from >= vertex_count)
+        {
+            throw std::out_of_range("Vertex is out of range");
+        }
+
+        SearchTree search_tree{std::vector<Weight>(vertex_count, ZERO_WEIGHT), std::vector<std::optional<EdgeId>>(vertex_count),
+                               std::vector<bool>(vertex_count, false)};
+        std::vector<Weight> &weights = search_tree.weights;
+        std::vector<std::optional<EdgeId>> &prev_edges = search_tree.prev_edges;
+        std::vector<bool> &reached = search_tree.reached;
+        std::vector<bool> settled(vertex_count, false);
+        std::vector<bool> is_target(vertex_count, false);
+        size_t targets_left = 0;
+        for (const VertexId target : targets)
+        {
+            if (target >= vertex_count)
+            {
+                throw std::out_of_range("Vertex is out of range");
+            }
+            if (!is_target[target])
+            {
+                is_target[target] = true;
+                ++targets_left;
+            }
+        }
+
+        Queue queue;
+        reached[from] = true;
+        queue.push({ZERO_WEIGHT, from});
+        while (!queue.empty())
+        {
+            const QueueItem item = queue.top();
+            queue.pop();
+            if (settled[item.vertex])
+            {
+                continue;
+            }
+            settled[item.vertex] = true;
+            if (is_target[item.vertex] && --targets_left == 0)
+            {
+                break;
+            }
+            graph_.ForEachIncidentEdge(item.vertex, [&](EdgeId edge_id, VertexId edge_to, Weight edge_weight)
+                                       {
+                                           const Weight candidate_weight = item.weight + edge_weight;
+                                           if (!reached[edge_to] || candidate_weight < weights[edge_to])
+                                           {
+                                               reached[edge_to] = true;
+                                               weights[edge_to] = candidate_weight;
+                                               prev_edges[edge_to] = edge_id;
+                                               queue.push({candidate_weight, edge_to});
+                                           }
+                                       });
+        }
+        return search_tree;
+    }
+
+    template <typename Weight, typename Graph>
+    std::optional<typename DijkstraRouter<Weight, Graph>::RouteInfo> DijkstraRouter<Weight, Graph>::ExtractRoute(const SearchTree &search_tree,
+                                                                                                                 VertexId to) const
+    {
+        if (!search_tree.reached[to])
+        {
+            return std::nullopt;
+        }
+        std::vector<EdgeId> edges;
+        for (std::optional<EdgeId> edge_id = search_tree.prev_edges[to];
+             edge_id;
+             edge_id = search_tree.prev_edges[graph_.GetEdge(*edge_id).from])
+        {
+            edges.push_back(*edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
+
+        return RouteInfo{search_tree.weights[to], std::move(edges)};
+    }
+
+} // namespace graph
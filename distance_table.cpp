@@ -0,0 +1,111 @@
+#include "distance_table.h"
+
+namespace catalogue
+{
+    void DistanceTable::Set(domain::StopId from, domain::StopId to, int distance)
+    {
+        // at most half of the slots are taken, probe sequences stay short
+        if ((used_ + 2) * 2 > entries_.size())
+        {
+            Grow();
+        }
+        Put(PackKey(from, to), distance, false);
+        const size_t reverse_slot = FindSlot(PackKey(to, from));
+        if (entries_[reverse_slot].key == EMPTY_KEY || entries_[reverse_slot].is_reverse)
+        {
+            Put(PackKey(to, from), distance, true);
+        }
+    }
+
+    void DistanceTable::Erase(domain::StopId from, domain::StopId to)
+    {
+        if (entries_.empty())
+        {
+            return;
+        }
+        const size_t slot = FindSlot(PackKey(from, to));
+        if (entries_[slot].key == EMPTY_KEY || entries_[slot].is_reverse)
+        {
+            return;
+        }
+        --size_;
+        const Entry &reverse = entries_[FindSlot(PackKey(to, from))];
+        if (from != to && reverse.key != EMPTY_KEY && !reverse.is_reverse)
+        {
+            entries_[slot].distance = reverse.distance;
+            entries_[slot].is_reverse = true;
+            return;
+        }
+        EraseSlot(slot);
+        if (from != to)
+        {
+            // the opposite direction has been a copy of this distance
+            EraseSlot(FindSlot(PackKey(to, from)));
+        }
+    }
+
+    size_t DistanceTable::size() const
+    {
+        return size_;
+    }
+
+    void DistanceTable::Put(uint64_t key, int distance, bool is_reverse)
+    {
+        Entry &entry = entries_[FindSlot(key)];
+        if (entry.key == EMPTY_KEY)
+        {
+            entry.key = key;
+            ++used_;
+            size_ += is_reverse ? 0 : 1;
+        }
+        else if (entry.is_reverse && !is_reverse)
+        {
+            ++size_;
+        }
+        entry.distance = distance;
+        entry.is_reverse = is_reverse;
+    }
+
+    void DistanceTable::EraseSlot(size_t slot)
+    {
+        if (entries_[slot].key == EMPTY_KEY)
+        {
+            return;
+        }
+        // the entries after the hole move back into it unless the hole lies before their home slot,
+        // so no probe sequence is broken
+        const size_t mask = entries_.size() - 1;
+        size_t hole = slot;
+        for (size_t next = (hole + 1) & mask; entries_[next].key != EMPTY_KEY; next = (next + 1) & mask)
+        {
+            if (((next - HomeSlot(entries_[next].key)) & mask) >= ((next - hole) & mask))
+            {
+                entries_[hole] = entries_[next];
+                hole = next;
+            }
+        }
+        entries_[hole] = Entry{};
+        --used_;
+    }
+
+    void DistanceTable::Grow()
+    {
+        std::vector<Entry> entries(entries_.empty() ? 16 : entries_.size() * 2);
+        entries.swap(entries_);
+        int bits = 0;
+        while ((size_t{1} << bits) < entries_.size())
+        {
+            ++bits;
+        }
+        shift_ = 64 - bits;
+        used_ = 0;
+        size_ = 0;
+        for (const Entry &entry : entries)
+        {
+            if (entry.key != EMPTY_KEY)
+            {
+                Put(entry.key, entry.distance, entry.is_reverse);
+            }
+        }
+    }
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "domain.h"
+
+namespace catalogue
+{
+    // Road distances in one open addressing table keyed by the packed (from, to) pair of stop ids.
+    // A distance is stored for the opposite direction as well until that direction gets its own one,
+    // so a lookup is a single probe sequence
+    class DistanceTable
+    {
+    public:
+        void Set(domain::StopId from, domain::StopId to, int distance);
+
+        std::optional<int> Find(domain::StopId from, domain::StopId to) const;
+
+        // The distance of the opposite direction, if it has been set, is used for this one again
+        void Erase(domain::StopId from, domain::StopId to);
+
+        // Number of the distances which have been set
+        size_t size() const;
+
+        // callback(StopId from, StopId to, int distance) is called for every distance which has been set
+        template <typename Callback>
+        void ForEach(Callback callback) const;
+
+    private:
+        static constexpr uint64_t EMPTY_KEY = std::numeric_limits<uint64_t>::max();
+
+        struct Entry
+        {
+            uint64_t key = EMPTY_KEY;
+            int distance = 0;
+            // true while the distance is the one of the opposite direction
+            bool is_reverse = false;
+        };
+
+        std::vector<Entry> entries_;
+        size_t used_ = 0;
+        size_t size_ = 0;
+        int shift_ = 64;
+
+        static uint64_t PackKey(domain::StopId from, domain::StopId to);
+
+        size_t HomeSlot(uint64_t key) const;
+
+        size_t FindSlot(uint64_t key) const;
+
+        void EraseSlot(size_t slot);
+
+        void Put(uint64_t key, int distance, bool is_reverse);
+
+        void Grow();
+    };
+
+    inline std::optional<int> DistanceTable::Find(domain::StopId from, domain::StopId to) const
+    {
+        if (entries_.empty())
+        {
+            return std::nullopt;
+        }
+        const Entry &entry = entries_[FindSlot(PackKey(from, to))];
+        if (entry.key == EMPTY_KEY)
+        {
+            return std::nullopt;
+        }
+        return entry.distance;
+    }
+
+    inline uint64_t DistanceTable::PackKey(domain::StopId from, domain::StopId to)
+    {
+        return static_cast<uint64_t>(from) << 32 | to;
+    }
+
+    inline size_t DistanceTable::HomeSlot(uint64_t key) const
+    {
+        // Fibonacci hashing: the top bits of the product are spread well even for neighbouring ids
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+
+    inline size_t DistanceTable::FindSlot(uint64_t key) const
+    {
+        const size_t mask = entries_.size() - 1;
+        size_t slot = HomeSlot(key);
+        while (entries_[slot].key != key && entries_[slot].key != EMPTY_KEY)
+        {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    template <typename Callback>
+    void DistanceTable::ForEach(Callback callback) const
+    {
+        for (const Entry &entry : entries_)
+        {
+            if (entry.key != EMPTY_KEY && !entry.is_reverse)
+            {
+                callback(static_cast<domain::StopId>(entry.key >> 32), static_cast<domain::StopId>(entry.key), entry.distance);
+            }
+        }
+    }
+}
@@ -1,14 +1,20 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <set>
 #include <unordered_map>
 
 #include "geo.h"
+#include "ranges.h"
 
 namespace domain
 {
+    // Dense numbers given to stops and buses in the order they are added to the catalogue
+    using StopId = uint32_t;
+    using BusId = uint32_t;
+
     struct BusInputInfo
     {
         std::string name_bus;
@@ -23,12 +29,34 @@ namespace domain
         std::unordered_map<std::string, int> distance_to_other_stops;
     };
 
+    // Stops and buses an update of the catalogue has touched, by their ids before the catalogue is renumbered
+    struct CatalogueChanges
+    {
+        std::vector<StopId> stops;
+        std::vector<BusId> buses;
+    };
+
+    struct Stop
+    {
+        std::string name;
+        geo::Coordinates coordinates;
+    };
+
     struct Bus
     {
-        std::vector<std::pair<std::string_view, const geo::Coordinates *>> stops;
+        std::string name;
+        std::vector<StopId> stops;
         bool is_circular = false;
     };
 
+    struct BusStatistics
+    {
+        int stops_on_route = 0;
+        int unique_stops = 0;
+        int route_length = 0;
+        double curvature = 0;
+    };
+
     struct BusInformation
     {
         std::string_view name_bus;
@@ -41,7 +69,8 @@ namespace domain
     struct StopInformation
     {
         std::string_view name_stop;
-        std::set<std::string_view> buses;
+        // sorted by name
+        ranges::Range<std::vector<BusId>::const_iterator> buses{{}, {}};
     };
 
     struct EdgeInfo
@@ -53,6 +82,16 @@ namespace domain
         std::string_view stop_to;
     };
 
+    // An edge of the routing graph by the ids of the catalogue; laid out as is in the flat base
+    struct EdgeRecord
+    {
+        BusId bus = 0;
+        StopId stop_from = 0;
+        StopId stop_to = 0;
+        uint32_t span_count = 0;
+        double time = 0;
+    };
+
     struct RouteInformation
     {
         double total_time = 0;
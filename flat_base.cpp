@@ -0,0 +1,467 @@
+#include "flat_base.h"
+#include "serialization.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+
+namespace serialization
+{
+    using namespace std::string_literals;
+
+    namespace
+    {
+        constexpr char MAGIC[8] = {'T', 'C', 'F', 'L', 'A', 'T', '\0', '\0'};
+        constexpr uint32_t VERSION = 2;
+        // written as is, a base of another byte order reads it differently
+        constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+        // every table starts at a multiple of the cache line, a mapping starts at a page
+        constexpr uint64_t ALIGNMENT = 64;
+
+        enum Section : size_t
+        {
+            SETTINGS,
+            RENDER_SETTINGS,
+            STRING_POOL,
+            STOPS,
+            BUSES,
+            BUS_STOPS,
+            DISTANCES,
+            GRAPH_OFFSETS,
+            GRAPH_SOURCES,
+            GRAPH_TARGETS,
+            GRAPH_WEIGHTS,
+            GRAPH_EDGE_IDS,
+            GRAPH_POSITIONS,
+            EDGES,
+            ROUTES_WEIGHTS,
+            ROUTES_PREV_EDGES,
+            HIERARCHY_RANKS,
+            HIERARCHY_SHORTCUTS,
+            SECTION_COUNT,
+        };
+
+        struct SectionEntry
+        {
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        struct Header
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t byte_order;
+            SectionEntry sections[SECTION_COUNT];
+        };
+
+        struct Settings
+        {
+            double bus_wait_time;
+            double bus_velocity;
+            uint32_t router_type;
+            uint32_t graph_model;
+        };
+
+        // names are [name_offset, name_offset + name_size) of the string pool
+        struct FlatStop
+        {
+            uint32_t name_offset;
+            uint32_t name_size;
+            double lat;
+            double lng;
+        };
+
+        // stops are [stops_offset, stops_offset + stop_count) of the bus stops table
+        struct FlatBus
+        {
+            uint32_t name_offset;
+            uint32_t name_size;
+            uint32_t stops_offset;
+            uint32_t stop_count;
+            uint32_t is_circular;
+            int32_t stops_on_route;
+            int32_t unique_stops;
+            int32_t route_length;
+            double curvature;
+        };
+
+        struct FlatDistance
+        {
+            domain::StopId stop_from;
+            domain::StopId stop_to;
+            int32_t distance;
+        };
+
+        struct FlatShortcut
+        {
+            uint32_t first;
+            uint32_t second;
+        };
+
+        using EdgeIndex = graph::CsrGraph<double>::EdgeIndex;
+        using PrevEdge = graph::Router<double>::PrevEdge;
+
+        static_assert(std::is_trivially_copyable_v<domain::EdgeRecord> && std::is_standard_layout_v<domain::EdgeRecord>);
+
+        uint64_t AlignUp(uint64_t offset)
+        {
+            return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        }
+
+        // Collects the tables and writes them after the header in the order of the sections
+        class TablesWriter
+        {
+        public:
+            void Add(Section section, const void *data, size_t size)
+            {
+                tables_[section] = {static_cast<const char *>(data), size};
+            }
+
+            template <typename T>
+            void Add(Section section, const std::vector<T> &table)
+            {
+                Add(section, table.data(), table.size() * sizeof(T));
+            }
+
+            void Write(std::ostream &output) const
+            {
+                Header header{};
+                std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+                header.version = VERSION;
+                header.byte_order = BYTE_ORDER_MARK;
+                uint64_t offset = AlignUp(sizeof(Header));
+                for (size_t section = 0; section < SECTION_COUNT; ++section)
+                {
+                    header.sections[section] = {offset, tables_[section].size()};
+                    offset = AlignUp(offset + tables_[section].size());
+                }
+                output.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+                WritePadding(output, sizeof(Header));
+                for (const std::string_view table : tables_)
+                {
+                    output.write(table.data(), table.size());
+                    WritePadding(output, table.size());
+                }
+            }
+
+        private:
+            std::string_view tables_[SECTION_COUNT];
+
+            static void WritePadding(std::ostream &output, uint64_t size)
+            {
+                static constexpr char ZEROS[ALIGNMENT] = {};
+                output.write(ZEROS, AlignUp(size) - size);
+            }
+        };
+    }
+
+    MappedFile::MappedFile(const std::string &path)
+    {
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd == -1)
+        {
+            throw std::runtime_error("Cannot open "s + path);
+        }
+        struct stat file_stat;
+        if (fstat(fd, &file_stat) == -1)
+        {
+            close(fd);
+            throw std::runtime_error("Cannot open "s + path);
+        }
+        size_ = file_stat.st_size;
+        if (size_ != 0)
+        {
+            data_ = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        // the mapping keeps the file open
+        close(fd);
+        if (data_ == MAP_FAILED)
+        {
+            data_ = nullptr;
+            throw std::runtime_error("Cannot map "s + path);
+        }
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (data_)
+        {
+            munmap(data_, size_);
+        }
+    }
+
+    std::string_view MappedFile::GetData() const
+    {
+        return {static_cast<const char *>(data_), size_};
+    }
+
+    bool IsFlatBase(const std::string &path)
+    {
+        std::ifstream input(path, std::ios::binary);
+        char magic[sizeof(MAGIC)] = {};
+        input.read(magic, sizeof(magic));
+        return input && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+    }
+
+    void SaveFlatBase(std::ostream &output, const catalogue::renderer::MapRenderer::RenderSettings &render_settings,
+                      const catalogue::tr_router::TransoprtRouter &transport_router, const graph::CsrGraph<double> &graph,
+                      const graph::RouterBase<double> &router)
+    {
+        const catalogue::TransportCatalogue &transport_catalogue = transport_router.GetTransoprtCatalogue();
+        TablesWriter writer;
+
+        const std::vector<Settings> settings{{transport_router.GetBusWaitTime(), transport_router.GetBusVelocity(),
+                                              static_cast<uint32_t>(transport_router.GetRouterType()),
+                                              static_cast<uint32_t>(transport_router.GetGraphModel())}};
+        writer.Add(SETTINGS, settings);
+        const std::string proto_render_settings = CreateProtoRenderSettings(render_settings).SerializeAsString();
+        writer.Add(RENDER_SETTINGS, proto_render_settings.data(), proto_render_settings.size());
+
+        std::string string_pool;
+        auto add_name = [&string_pool](const std::string &name)
+        {
+            if (string_pool.size() + name.size() > std::numeric_limits<uint32_t>::max())
+            {
+                throw std::length_error("String pool is too large for the flat base"s);
+            }
+            const uint32_t offset = string_pool.size();
+            string_pool += name;
+            return offset;
+        };
+        std::vector<FlatStop> stops;
+        stops.reserve(transport_catalogue.GetAllStops().size());
+        for (const domain::Stop &stop : transport_catalogue.GetAllStops())
+        {
+            stops.push_back({add_name(stop.name), static_cast<uint32_t>(stop.name.size()), stop.coordinates.lat, stop.coordinates.lng});
+        }
+        std::vector<FlatBus> buses;
+        std::vector<domain::StopId> bus_stops;
+        buses.reserve(transport_catalogue.GetAllBuses().size());
+        for (domain::BusId id = 0; id < transport_catalogue.GetAllBuses().size(); ++id)
+        {
+            const domain::Bus &bus = transport_catalogue.GetBus(id);
+            const domain::BusStatistics &statistics = transport_catalogue.GetBusStatistics(id);
+            buses.push_back({add_name(bus.name), static_cast<uint32_t>(bus.name.size()), static_cast<uint32_t>(bus_stops.size()),
+                             static_cast<uint32_t>(bus.stops.size()), bus.is_circular, statistics.stops_on_route,
+                             statistics.unique_stops, statistics.route_length, statistics.curvature});
+            bus_stops.insert(bus_stops.end(), bus.stops.begin(), bus.stops.end());
+        }
+        std::vector<FlatDistance> distances;
+        distances.reserve(transport_catalogue.GetDistanceBetweenStops().size());
+        transport_catalogue.GetDistanceBetweenStops().ForEach([&distances](domain::StopId stop_from, domain::StopId stop_to, int distance)
+                                                              { distances.push_back({stop_from, stop_to, distance}); });
+        // in the order of the ids rather than of the hash table, so the same catalogue always gives the same file
+        std::sort(distances.begin(), distances.end(), [](const FlatDistance &lhs, const FlatDistance &rhs)
+                  { return std::tie(lhs.stop_from, lhs.stop_to) < std::tie(rhs.stop_from, rhs.stop_to); });
+        writer.Add(STRING_POOL, string_pool.data(), string_pool.size());
+        writer.Add(STOPS, stops);
+        writer.Add(BUSES, buses);
+        writer.Add(BUS_STOPS, bus_stops);
+        writer.Add(DISTANCES, distances);
+
+        const graph::CsrGraph<double>::Arrays &arrays = graph.GetArrays();
+        writer.Add(GRAPH_OFFSETS, arrays.offsets, (arrays.vertex_count + 1) * sizeof(EdgeIndex));
+        writer.Add(GRAPH_SOURCES, arrays.sources, arrays.edge_count * sizeof(EdgeIndex));
+        writer.Add(GRAPH_TARGETS, arrays.targets, arrays.edge_count * sizeof(EdgeIndex));
+        writer.Add(GRAPH_WEIGHTS, arrays.weights, arrays.edge_count * sizeof(double));
+        writer.Add(GRAPH_EDGE_IDS, arrays.edge_ids, arrays.edge_count * sizeof(EdgeIndex));
+        writer.Add(GRAPH_POSITIONS, arrays.positions, arrays.edge_count * sizeof(EdgeIndex));
+        std::vector<domain::EdgeRecord> edges;
+        edges.reserve(transport_router.GetEdgeCount());
+        for (size_t edge = 0; edge < transport_router.GetEdgeCount(); ++edge)
+        {
+            edges.push_back(transport_router.GetEdgeRecord(edge));
+        }
+        writer.Add(EDGES, edges);
+
+        std::vector<uint32_t> ranks;
+        std::vector<FlatShortcut> shortcuts;
+        if (const auto *all_pairs = dynamic_cast<const graph::Router<double> *>(&router))
+        {
+            const graph::Router<double>::RoutesTableView &routes_table = all_pairs->GetRoutesTable();
+            const size_t cell_count = routes_table.vertex_count * routes_table.vertex_count;
+            writer.Add(ROUTES_WEIGHTS, routes_table.weights, cell_count * sizeof(double));
+            writer.Add(ROUTES_PREV_EDGES, routes_table.prev_edges, cell_count * sizeof(PrevEdge));
+        }
+        else if (const auto *hierarchy = dynamic_cast<const graph::ContractionHierarchy<double> *>(&router))
+        {
+            ranks.assign(hierarchy->GetRanks().begin(), hierarchy->GetRanks().end());
+            shortcuts.reserve(hierarchy->GetShortcuts().size());
+            for (const auto &shortcut : hierarchy->GetShortcuts())
+            {
+                shortcuts.push_back({static_cast<uint32_t>(shortcut.first), static_cast<uint32_t>(shortcut.second)});
+            }
+            writer.Add(HIERARCHY_RANKS, ranks);
+            writer.Add(HIERARCHY_SHORTCUTS, shortcuts);
+        }
+        writer.Write(output);
+    }
+
+    FlatBase::FlatBase(std::string_view data)
+        : data_(data)
+    {
+        if (data_.size() < sizeof(Header))
+        {
+            throw std::invalid_argument("Corrupted flat base"s);
+        }
+        const Header &header = *reinterpret_cast<const Header *>(data_.data());
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.byte_order != BYTE_ORDER_MARK)
+        {
+            throw std::invalid_argument("Not a flat base"s);
+        }
+        if (header.version != VERSION)
+        {
+            throw std::invalid_argument("Unsupported flat base version "s + std::to_string(header.version));
+        }
+        for (const SectionEntry &section : header.sections)
+        {
+            if (section.offset % ALIGNMENT != 0 || section.offset > data_.size() || section.size > data_.size() - section.offset)
+            {
+                throw std::invalid_argument("Corrupted flat base"s);
+            }
+        }
+    }
+
+    template <typename T>
+    FlatBase::Table<T> FlatBase::GetTable(size_t section) const
+    {
+        const SectionEntry &entry = reinterpret_cast<const Header *>(data_.data())->sections[section];
+        if (entry.size % sizeof(T) != 0)
+        {
+            throw std::invalid_argument("Corrupted flat base"s);
+        }
+        return {reinterpret_cast<const T *>(data_.data() + entry.offset), entry.size / sizeof(T)};
+    }
+
+    catalogue::TransportCatalogue FlatBase::LoadCatalogue() const
+    {
+        const Table<char> string_pool = GetTable<char>(STRING_POOL);
+        const Table<FlatStop> stops = GetTable<FlatStop>(STOPS);
+        const Table<FlatBus> buses = GetTable<FlatBus>(BUSES);
+        const Table<domain::StopId> bus_stops = GetTable<domain::StopId>(BUS_STOPS);
+        const Table<FlatDistance> distances = GetTable<FlatDistance>(DISTANCES);
+        auto get_name = [&string_pool](uint32_t offset, uint32_t size)
+        {
+            if (offset > string_pool.size || size > string_pool.size - offset)
+            {
+                throw std::invalid_argument("Corrupted flat base"s);
+            }
+            return std::string(string_pool.items + offset, size);
+        };
+
+        catalogue::TransportCatalogue transport_catalogue;
+        for (size_t i = 0; i < stops.size; ++i)
+        {
+            domain::StopInputInfo stop_info;
+            stop_info.name_stop = get_name(stops[i].name_offset, stops[i].name_size);
+            stop_info.coordinates = {stops[i].lat, stops[i].lng};
+            transport_catalogue.AddStop(std::move(stop_info));
+        }
+        for (size_t i = 0; i < distances.size; ++i)
+        {
+            transport_catalogue.SetDistanceBetweenStops(distances[i].stop_from, distances[i].stop_to, distances[i].distance);
+        }
+        for (size_t i = 0; i < buses.size; ++i)
+        {
+            const FlatBus &flat_bus = buses[i];
+            if (flat_bus.stops_offset > bus_stops.size || flat_bus.stop_count > bus_stops.size - flat_bus.stops_offset)
+            {
+                throw std::invalid_argument("Corrupted flat base"s);
+            }
+            domain::Bus bus;
+            bus.name = get_name(flat_bus.name_offset, flat_bus.name_size);
+            bus.stops.assign(bus_stops.items + flat_bus.stops_offset, bus_stops.items + flat_bus.stops_offset + flat_bus.stop_count);
+            bus.is_circular = flat_bus.is_circular;
+            const domain::BusId id = transport_catalogue.AddBus(std::move(bus));
+            transport_catalogue.SetBusStatistics(id, {flat_bus.stops_on_route, flat_bus.unique_stops, flat_bus.route_length, flat_bus.curvature});
+        }
+        transport_catalogue.Finalize();
+        return transport_catalogue;
+    }
+
+    catalogue::renderer::MapRenderer::RenderSettings FlatBase::LoadRenderSettings() const
+    {
+        const Table<char> table = GetTable<char>(RENDER_SETTINGS);
+        proto_map_renderer::RenderSettings proto_render_settings;
+        if (!proto_render_settings.ParseFromArray(table.items, table.size))
+        {
+            throw std::invalid_argument("Corrupted flat base"s);
+        }
+        return DeserializeMapRenderer(proto_render_settings);
+    }
+
+    void FlatBase::LoadTransportRouter(catalogue::tr_router::TransoprtRouter &tr_router) const
+    {
+        const Table<Settings> settings = GetTable<Settings>(SETTINGS);
+        if (settings.size != 1 || settings[0].router_type > static_cast<uint32_t>(catalogue::tr_router::RouterType::CONTRACTION_HIERARCHIES) ||
+            settings[0].graph_model > static_cast<uint32_t>(catalogue::tr_router::GraphModel::RIDE_SEGMENTS))
+        {
+            throw std::invalid_argument("Corrupted flat base"s);
+        }
+        tr_router.SetBusWaitTime(settings[0].bus_wait_time);
+        tr_router.SetBusVelocity(settings[0].bus_velocity);
+        tr_router.SetRouterType(static_cast<catalogue::tr_router::RouterType>(settings[0].router_type));
+        tr_router.SetGraphModel(static_cast<catalogue::tr_router::GraphModel>(settings[0].graph_model));
+        const Table<domain::EdgeRecord> edges = GetTable<domain::EdgeRecord>(EDGES);
+        tr_router.SetEdgeRecords(edges.items, edges.size);
+    }
+
+    graph::CsrGraph<double> FlatBase::LoadGraph() const
+    {
+        const Table<EdgeIndex> offsets = GetTable<EdgeIndex>(GRAPH_OFFSETS);
+        const Table<EdgeIndex> sources = GetTable<EdgeIndex>(GRAPH_SOURCES);
+        const Table<EdgeIndex> targets = GetTable<EdgeIndex>(GRAPH_TARGETS);
+        const Table<double> weights = GetTable<double>(GRAPH_WEIGHTS);
+        const Table<EdgeIndex> edge_ids = GetTable<EdgeIndex>(GRAPH_EDGE_IDS);
+        const Table<EdgeIndex> positions = GetTable<EdgeIndex>(GRAPH_POSITIONS);
+        const size_t edge_count = targets.size;
+        if (offsets.size == 0 || offsets[0] != 0 || offsets[offsets.size - 1] != edge_count || sources.size != edge_count ||
+            weights.size != edge_count || edge_ids.size != edge_count || positions.size != edge_count || GetTable<domain::EdgeRecord>(EDGES).size != edge_count)
+        {
+            throw std::invalid_argument("Corrupted flat base"s);
+        }
+        return graph::CsrGraph<double>({offsets.size - 1, edge_count, offsets.items, sources.items, targets.items, weights.items, edge_ids.items, positions.items});
+    }
+
+    std::unique_ptr<graph::RouterBase<double>> FlatBase::LoadRouter(const catalogue::tr_router::TransoprtRouter &tr_router,
+                                                                    const graph::CsrGraph<double> &graph) const
+    {
+        const size_t vertex_count = graph.GetVertexCount();
+        if (tr_router.GetRouterType() == catalogue::tr_router::RouterType::ALL_PAIRS)
+        {
+            const Table<double> weights = GetTable<double>(ROUTES_WEIGHTS);
+            const Table<PrevEdge> prev_edges = GetTable<PrevEdge>(ROUTES_PREV_EDGES);
+            if (weights.size == vertex_count * vertex_count && prev_edges.size == vertex_count * vertex_count)
+            {
+                return std::make_unique<graph::Router<double>>(graph, graph::Router<double>::RoutesTableView{vertex_count, weights.items, prev_edges.items});
+            }
+        }
+        else if (tr_router.GetRouterType() == catalogue::tr_router::RouterType::CONTRACTION_HIERARCHIES)
+        {
+            const Table<uint32_t> ranks = GetTable<uint32_t>(HIERARCHY_RANKS);
+            const Table<FlatShortcut> shortcuts = GetTable<FlatShortcut>(HIERARCHY_SHORTCUTS);
+            if (ranks.size == vertex_count)
+            {
+                std::vector<graph::ContractionHierarchy<double>::Shortcut> hierarchy_shortcuts;
+                hierarchy_shortcuts.reserve(shortcuts.size);
+                for (size_t i = 0; i < shortcuts.size; ++i)
+                {
+                    hierarchy_shortcuts.push_back({shortcuts[i].first, shortcuts[i].second});
+                }
+                return std::make_unique<graph::ContractionHierarchy<double>>(graph, std::vector<size_t>(ranks.items, ranks.items + ranks.size),
+                                                                             std::move(hierarchy_shortcuts));
+            }
+        }
+        return tr_router.CreateRouter(graph);
+    }
+}
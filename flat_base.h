@@ -0,0 +1,81 @@
+#pragma once
+
+#include "transport_router.h"
+#include "map_renderer.h"
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace serialization
+{
+    // Read-only mapping of a whole file. The pages come from the page cache, so every process mapping the file shares them
+    class MappedFile
+    {
+    public:
+        explicit MappedFile(const std::string &path);
+
+        MappedFile(const MappedFile &) = delete;
+
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        ~MappedFile();
+
+        std::string_view GetData() const;
+
+    private:
+        void *data_ = nullptr;
+        size_t size_ = 0;
+    };
+
+    // The flat base is a header with the offsets of the tables followed by the tables themselves, laid out the way
+    // they are used in memory: string pool, stops, buses and their stops, distances, CSR graph, edge records,
+    // routes table or contraction hierarchy
+    bool IsFlatBase(const std::string &path);
+
+    // The routes table or the hierarchy is stored when the router is the one of the graph model
+    void SaveFlatBase(std::ostream &output, const catalogue::renderer::MapRenderer::RenderSettings &render_settings,
+                      const catalogue::tr_router::TransoprtRouter &transport_router, const graph::CsrGraph<double> &graph,
+                      const graph::RouterBase<double> &router);
+
+    // The graph, the edge records and the routes table are served from the data in place, the catalogue and
+    // the hierarchy are rebuilt from their tables without parsing. Only the bounds of the tables are checked,
+    // their contents are trusted as written by SaveFlatBase
+    class FlatBase
+    {
+    public:
+        // The data has to outlive the base and everything loaded from it
+        explicit FlatBase(std::string_view data);
+
+        catalogue::TransportCatalogue LoadCatalogue() const;
+
+        catalogue::renderer::MapRenderer::RenderSettings LoadRenderSettings() const;
+
+        // The router has to be created over the catalogue loaded from the base
+        void LoadTransportRouter(catalogue::tr_router::TransoprtRouter &tr_router) const;
+
+        graph::CsrGraph<double> LoadGraph() const;
+
+        std::unique_ptr<graph::RouterBase<double>> LoadRouter(const catalogue::tr_router::TransoprtRouter &tr_router,
+                                                              const graph::CsrGraph<double> &graph) const;
+
+    private:
+        template <typename T>
+        struct Table
+        {
+            const T *items = nullptr;
+            size_t size = 0;
+
+            const T &operator[](size_t index) const
+            {
+                return items[index];
+            }
+        };
+
+        std::string_view data_;
+
+        template <typename T>
+        Table<T> GetTable(size_t section) const;
+    };
+}
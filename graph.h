@@ -3,6 +3,7 @@
 #include "ranges.h"
 
 #include <cstdlib>
+#include <limits>
 #include <vector>
 
 namespace graph
@@ -19,6 +20,16 @@ namespace graph
         Weight weight;
     };
 
+    // The ids a graph rebuilt after a change gives to the vertices and the edges of the graph before it,
+    // REMOVED for the ones it has lost. Edges of the new graph which are not there are the added ones
+    struct GraphUpdate
+    {
+        static constexpr size_t REMOVED = std::numeric_limits<size_t>::max();
+
+        std::vector<VertexId> vertices;
+        std::vector<EdgeId> edges;
+    };
+
     template <typename Weight>
     class DirectedWeightedGraph
     {
@@ -36,6 +47,10 @@ namespace graph
         const Edge<Weight> &GetEdge(EdgeId edge_id) const;
         IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
 
+        // callback(EdgeId edge_id, VertexId to, Weight weight) is called for every edge going out of the vertex
+        template <typename Callback>
+        void ForEachIncidentEdge(VertexId vertex, Callback callback) const;
+
     private:
         std::vector<Edge<Weight>> edges_;
         std::vector<IncidenceList> incidence_lists_;
@@ -80,4 +95,15 @@ namespace graph
     {
         return ranges::AsRange(incidence_lists_.at(vertex));
     }
+
+    template <typename Weight>
+    template <typename Callback>
+    void DirectedWeightedGraph<Weight>::ForEachIncidentEdge(VertexId vertex, Callback callback) const
+    {
+        for (const EdgeId edge_id : incidence_lists_[vertex])
+        {
+            const auto &edge = edges_[edge_id];
+            callback(edge_id, edge.to, edge.weight);
+        }
+    }
 } // namespace graph
\ No newline at end of file
@@ -1,6 +1,15 @@
 #include "json.h"
 
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
 #include <iterator>
+#include <string_view>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define JSON_BLOCK_SCANNER_X86
+#include <immintrin.h>
+#endif
 
 namespace json
 {
@@ -8,407 +17,770 @@ namespace json
     {
         using namespace std::literals;
 
-        Node LoadNode(std::istream &input);
-        Node LoadString(std::istream &input);
-
-        std::string LoadLiteral(std::istream &input)
+        // First stage of the parser: the input is classified by 64-byte blocks into bit masks, bit i of a mask stands
+        // for byte i of the block. The masks are built with SSE2 or AVX2 when the processor has them, a window of
+        // blocks at a time, so the second stage can jump over whitespace and plain string characters
+        class BlockScanner
         {
-            std::string s;
-            while (std::isalpha(input.peek()))
+        public:
+            explicit BlockScanner(std::string_view input)
+                : begin_(input.data()), size_(input.size()), classify_(SelectClassify())
             {
-                s.push_back(static_cast<char>(input.get()));
             }
-            return s;
-        }
 
-        Node LoadArray(std::istream &input)
-        {
-            std::vector<Node> result;
+            // The first character at or after position which is not whitespace, or the end of the input
+            const char *SkipWhitespace(const char *position)
+            {
+                return FindFirst(position, &BlockMasks::whitespace, true);
+            }
 
-            for (char c; input >> c && c != ']';)
+            // The first '"', '\\', '\n' or '\r' at or after position, or the end of the input
+            const char *FindStringSpecial(const char *position)
             {
-                if (c != ',')
-                {
-                    input.putback(c);
-                }
-                result.push_back(LoadNode(input));
+                return FindFirst(position, &BlockMasks::string_special, false);
+            }
+
+        private:
+            static constexpr size_t BLOCK_SIZE = 64;
+            static constexpr size_t WINDOW_BLOCKS = 1024;
+
+            struct BlockMasks
+            {
+                uint64_t whitespace = 0;
+                uint64_t string_special = 0;
+            };
+            using ClassifyFunction = BlockMasks (*)(const char *block);
+
+            const char *begin_;
+            size_t size_;
+            ClassifyFunction classify_;
+            std::vector<BlockMasks> window_;
+            size_t window_first_ = 0;
+
+            static bool IsWhitespace(char c)
+            {
+                return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
             }
-            if (!input)
+
+            static bool IsStringSpecial(char c)
             {
-                throw ParsingError("Array parsing error"s);
+                return c == '"' || c == '\\' || c == '\n' || c == '\r';
             }
-            return Node(std::move(result));
-        }
 
-        Node LoadDict(std::istream &input)
-        {
-            Dict dict;
-            for (char c; input >> c && c != '}';)
+            static BlockMasks ClassifyScalar(const char *block)
             {
-                if (c == '"')
+                BlockMasks masks;
+                for (size_t i = 0; i < BLOCK_SIZE; ++i)
                 {
-                    std::string key = LoadString(input).AsString();
-                    if (input >> c && c == ':')
-                    {
-                        if (dict.find(key) != dict.end())
-                        {
-                            throw ParsingError("Duplicate key '"s + key + "' have been found");
-                        }
-                        dict.emplace(std::move(key), LoadNode(input));
-                    }
-                    else
-                    {
-                        throw ParsingError(": is expected but '"s + c + "' has been found"s);
-                    }
+                    masks.whitespace |= static_cast<uint64_t>(IsWhitespace(block[i])) << i;
+                    masks.string_special |= static_cast<uint64_t>(IsStringSpecial(block[i])) << i;
                 }
-                else if (c != ',')
+                return masks;
+            }
+
+#ifdef JSON_BLOCK_SCANNER_X86
+            static BlockMasks ClassifySse2(const char *block)
+            {
+                BlockMasks masks;
+                for (size_t i = 0; i < BLOCK_SIZE; i += 16)
                 {
-                    throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+                    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + i));
+                    const __m128i new_line = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n'));
+                    const __m128i carriage_return = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\r'));
+                    // '\t', '\n', '\v', '\f' and '\r' are the codes 9..13
+                    const __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(_mm_sub_epi8(bytes, _mm_set1_epi8('\t')), _mm_set1_epi8(4)),
+                                                           _mm_sub_epi8(bytes, _mm_set1_epi8('\t')));
+                    const __m128i whitespace = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')), control);
+                    const __m128i string_special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('"')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\\'))),
+                                                                _mm_or_si128(new_line, carriage_return));
+                    masks.whitespace |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(whitespace))) << i;
+                    masks.string_special |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(string_special))) << i;
                 }
+                return masks;
             }
-            if (!input)
+
+            __attribute__((target("avx2"))) static BlockMasks ClassifyAvx2(const char *block)
             {
-                throw ParsingError("Dictionary parsing error"s);
+                BlockMasks masks;
+                for (size_t i = 0; i < BLOCK_SIZE; i += 32)
+                {
+                    const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + i));
+                    const __m256i new_line = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n'));
+                    const __m256i carriage_return = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\r'));
+                    const __m256i shifted = _mm256_sub_epi8(bytes, _mm256_set1_epi8('\t'));
+                    const __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(4)), shifted);
+                    const __m256i whitespace = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')), control);
+                    const __m256i string_special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\\'))),
+                                                                   _mm256_or_si256(new_line, carriage_return));
+                    masks.whitespace |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(whitespace))) << i;
+                    masks.string_special |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(string_special))) << i;
+                }
+                return masks;
             }
-            return Node(std::move(dict));
-        }
+#endif
 
-        Node LoadString(std::istream &input)
-        {
-            auto it = std::istreambuf_iterator<char>(input);
-            auto end = std::istreambuf_iterator<char>();
-            std::string s;
-            while (true)
+            static ClassifyFunction SelectClassify()
             {
-                if (it == end)
+#ifdef JSON_BLOCK_SCANNER_X86
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx2"))
                 {
-                    throw ParsingError("String parsing error");
+                    return ClassifyAvx2;
                 }
-                const char ch = *it;
-                if (ch == '"')
+                return ClassifySse2;
+#else
+                return ClassifyScalar;
+#endif
+            }
+
+            const BlockMasks &GetBlock(size_t block)
+            {
+                if (block < window_first_ || block >= window_first_ + window_.size())
                 {
-                    ++it;
-                    break;
+                    const size_t block_count = (size_ + BLOCK_SIZE - 1) / BLOCK_SIZE;
+                    window_first_ = block;
+                    window_.resize(std::min(WINDOW_BLOCKS, block_count - block));
+                    for (size_t i = 0; i < window_.size(); ++i)
+                    {
+                        const size_t offset = (block + i) * BLOCK_SIZE;
+                        if (offset + BLOCK_SIZE <= size_)
+                        {
+                            window_[i] = classify_(begin_ + offset);
+                            continue;
+                        }
+                        // the tail is padded with a character which is neither whitespace nor special
+                        char tail[BLOCK_SIZE];
+                        std::fill(std::copy(begin_ + offset, begin_ + size_, tail), tail + BLOCK_SIZE, 'x');
+                        window_[i] = classify_(tail);
+                    }
                 }
-                else if (ch == '\\')
+                return window_[block - window_first_];
+            }
+
+            const char *FindFirst(const char *position, uint64_t BlockMasks::*mask, bool inverted)
+            {
+                size_t offset = position - begin_;
+                while (offset < size_)
                 {
-                    ++it;
-                    if (it == end)
+                    uint64_t bits = GetBlock(offset / BLOCK_SIZE).*mask;
+                    if (inverted)
                     {
-                        throw ParsingError("String parsing error");
+                        bits = ~bits;
                     }
-                    const char escaped_char = *(it);
-                    switch (escaped_char)
+                    bits >>= offset % BLOCK_SIZE;
+                    if (bits != 0)
                     {
-                    case 'n':
-                        s.push_back('\n');
-                        break;
-                    case 't':
-                        s.push_back('\t');
-                        break;
-                    case 'r':
-                        s.push_back('\r');
-                        break;
-                    case '"':
-                        s.push_back('"');
-                        break;
-                    case '\\':
-                        s.push_back('\\');
-                        break;
-                    default:
-                        throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
+                        return begin_ + std::min(size_, offset + __builtin_ctzll(bits));
                     }
+                    offset = (offset / BLOCK_SIZE + 1) * BLOCK_SIZE;
                 }
-                else if (ch == '\n' || ch == '\r')
+                return begin_ + size_;
+            }
+        };
+
+        // Second stage: recursive descent parser over a contiguous buffer, which reports the document to Handler
+        // event by event. It accepts the same documents as the former istream-based parser and reports the same errors
+        template <typename Handler>
+        class Parser
+        {
+        public:
+            Parser(std::string_view input, Handler &handler)
+                : position_(input.data()), end_(input.data() + input.size()), scanner_(input), handler_(handler)
+            {
+            }
+
+            void ParseNode()
+            {
+                char c;
+                if (!ReadChar(c))
                 {
-                    throw ParsingError("Unexpected end of line"s);
+                    throw ParsingError("Unexpected EOF"s);
                 }
-                else
+                switch (c)
                 {
-                    s.push_back(ch);
+                case '[':
+                    ParseArray();
+                    break;
+                case '{':
+                    ParseDict();
+                    break;
+                case '"':
+                    handler_.Value(LoadString());
+                    break;
+                case 't':
+                    [[fallthrough]];
+                case 'f':
+                    --position_;
+                    handler_.Value(LoadBool());
+                    break;
+                case 'n':
+                    --position_;
+                    handler_.Value(LoadNull());
+                    break;
+                default:
+                    --position_;
+                    handler_.Value(LoadNumber());
+                    break;
                 }
-                ++it;
             }
-            return Node(std::move(s));
-        }
 
-        Node LoadBool(std::istream &input)
-        {
-            const auto s = LoadLiteral(input);
-            if (s == "true"sv)
+        private:
+            const char *position_;
+            const char *end_;
+            BlockScanner scanner_;
+            Handler &handler_;
+
+            static bool IsSpace(char c)
             {
-                return Node{true};
+                return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
             }
-            else if (s == "false"sv)
+
+            static bool IsDigit(char c)
             {
-                return Node{false};
+                return c >= '0' && c <= '9';
             }
-            else
+
+            static bool IsAlpha(char c)
             {
-                throw ParsingError("Failed to parse '"s + s + "' as bool"s);
+                return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
             }
-        }
 
-        Node LoadNull(std::istream &input)
-        {
-            if (auto literal = LoadLiteral(input); literal == "null"sv)
+            // Skips whitespace and reads the next character, like input >> c
+            bool ReadChar(char &c)
             {
-                return Node{nullptr};
+                // a single separating space is more common than a long indentation
+                if (position_ != end_ && IsSpace(*position_))
+                {
+                    position_ = scanner_.SkipWhitespace(position_ + 1);
+                }
+                if (position_ == end_)
+                {
+                    return false;
+                }
+                c = *position_++;
+                return true;
             }
-            else
+
+            bool PeekIs(char c) const
             {
-                throw ParsingError("Failed to parse '"s + literal + "' as null"s);
+                return position_ != end_ && *position_ == c;
             }
-        }
 
-        Node LoadNumber(std::istream &input)
-        {
-            std::string parsed_num;
+            std::string_view LoadLiteral()
+            {
+                const char *begin = position_;
+                while (position_ != end_ && IsAlpha(*position_))
+                {
+                    ++position_;
+                }
+                return {begin, static_cast<size_t>(position_ - begin)};
+            }
 
-            auto read_char = [&parsed_num, &input]
+            void ParseArray()
             {
-                parsed_num += static_cast<char>(input.get());
-                if (!input)
+                handler_.StartArray();
+                char c;
+                bool closed = false;
+                while (ReadChar(c))
                 {
-                    throw ParsingError("Failed to read number from stream"s);
+                    if (c == ']')
+                    {
+                        closed = true;
+                        break;
+                    }
+                    if (c != ',')
+                    {
+                        --position_;
+                    }
+                    ParseNode();
                 }
-            };
+                if (!closed)
+                {
+                    throw ParsingError("Array parsing error"s);
+                }
+                handler_.EndArray();
+            }
 
-            auto read_digits = [&input, read_char]
+            void ParseDict()
             {
-                if (!std::isdigit(input.peek()))
+                handler_.StartDict();
+                char c;
+                bool closed = false;
+                while (ReadChar(c))
                 {
-                    throw ParsingError("A digit is expected"s);
+                    if (c == '}')
+                    {
+                        closed = true;
+                        break;
+                    }
+                    if (c == '"')
+                    {
+                        std::string key = LoadStringValue();
+                        if (ReadChar(c) && c == ':')
+                        {
+                            handler_.Key(std::move(key));
+                            ParseNode();
+                        }
+                        else
+                        {
+                            throw ParsingError(": is expected but '"s + c + "' has been found"s);
+                        }
+                    }
+                    else if (c != ',')
+                    {
+                        throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+                    }
                 }
-                while (std::isdigit(input.peek()))
+                if (!closed)
                 {
-                    read_char();
+                    throw ParsingError("Dictionary parsing error"s);
                 }
-            };
+                handler_.EndDict();
+            }
 
-            if (input.peek() == '-')
+            std::string LoadStringValue()
             {
-                read_char();
+                std::string s;
+                while (true)
+                {
+                    // characters without a special meaning are copied in runs
+                    const char *run_begin = position_;
+                    position_ = scanner_.FindStringSpecial(position_);
+                    s.append(run_begin, position_);
+                    if (position_ == end_)
+                    {
+                        throw ParsingError("String parsing error");
+                    }
+                    const char ch = *position_++;
+                    if (ch == '"')
+                    {
+                        break;
+                    }
+                    else if (ch == '\\')
+                    {
+                        if (position_ == end_)
+                        {
+                            throw ParsingError("String parsing error");
+                        }
+                        const char escaped_char = *position_++;
+                        switch (escaped_char)
+                        {
+                        case 'n':
+                            s.push_back('\n');
+                            break;
+                        case 't':
+                            s.push_back('\t');
+                            break;
+                        case 'r':
+                            s.push_back('\r');
+                            break;
+                        case '"':
+                            s.push_back('"');
+                            break;
+                        case '\\':
+                            s.push_back('\\');
+                            break;
+                        default:
+                            throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
+                        }
+                    }
+                    else
+                    {
+                        throw ParsingError("Unexpected end of line"s);
+                    }
+                }
+                return s;
             }
-            if (input.peek() == '0')
+
+            Node LoadString()
             {
-                read_char();
+                return Node(LoadStringValue());
             }
-            else
+
+            Node LoadBool()
             {
-                read_digits();
+                const std::string_view s = LoadLiteral();
+                if (s == "true"sv)
+                {
+                    return Node{true};
+                }
+                else if (s == "false"sv)
+                {
+                    return Node{false};
+                }
+                else
+                {
+                    throw ParsingError("Failed to parse '"s + std::string(s) + "' as bool"s);
+                }
             }
 
-            bool is_int = true;
-            if (input.peek() == '.')
+            Node LoadNull()
             {
-                read_char();
-                read_digits();
-                is_int = false;
+                if (const std::string_view literal = LoadLiteral(); literal == "null"sv)
+                {
+                    return Node{nullptr};
+                }
+                else
+                {
+                    throw ParsingError("Failed to parse '"s + std::string(literal) + "' as null"s);
+                }
             }
 
-            if (int ch = input.peek(); ch == 'e' || ch == 'E')
+            void ReadDigits()
             {
-                read_char();
-                if (ch = input.peek(); ch == '+' || ch == '-')
+                if (position_ == end_ || !IsDigit(*position_))
                 {
-                    read_char();
+                    throw ParsingError("A digit is expected"s);
+                }
+                while (position_ != end_ && IsDigit(*position_))
+                {
+                    ++position_;
                 }
-                read_digits();
-                is_int = false;
             }
 
-            try
+            Node LoadNumber()
             {
-                if (is_int)
+                const char *begin = position_;
+                if (PeekIs('-'))
+                {
+                    ++position_;
+                }
+                if (PeekIs('0'))
+                {
+                    ++position_;
+                }
+                else
+                {
+                    ReadDigits();
+                }
+
+                bool is_int = true;
+                if (PeekIs('.'))
                 {
-                    try
+                    ++position_;
+                    ReadDigits();
+                    is_int = false;
+                }
+
+                if (PeekIs('e') || PeekIs('E'))
+                {
+                    ++position_;
+                    if (PeekIs('+') || PeekIs('-'))
                     {
-                        return std::stoi(parsed_num);
+                        ++position_;
                     }
-                    catch (...)
+                    ReadDigits();
+                    is_int = false;
+                }
+
+                if (is_int)
+                {
+                    int value = 0;
+                    if (const auto [end, error] = std::from_chars(begin, position_, value); error == std::errc{} && end == position_)
                     {
+                        return value;
                     }
                 }
-                return std::stod(parsed_num);
+                double value = 0;
+                if (const auto [end, error] = std::from_chars(begin, position_, value); error == std::errc{} && end == position_)
+                {
+                    return value;
+                }
+                throw ParsingError("Failed to convert "s + std::string(begin, position_) + " to number"s);
             }
-            catch (...)
+        };
+
+        std::string ReadAll(std::istream &input)
+        {
+            std::string buffer;
+            char chunk[1 << 16];
+            while (input.read(chunk, sizeof(chunk)) || input.gcount() > 0)
             {
-                throw ParsingError("Failed to convert "s + parsed_num + " to number"s);
+                buffer.append(chunk, static_cast<size_t>(input.gcount()));
             }
+            return buffer;
         }
+    }
+
+    void NodeBuilder::StartArray()
+    {
+        arrays_.emplace_back();
+        in_dict_.push_back(false);
+    }
+
+    void NodeBuilder::EndArray()
+    {
+        Node array(std::move(arrays_.back()));
+        arrays_.pop_back();
+        in_dict_.pop_back();
+        Value(std::move(array));
+    }
 
-        Node LoadNode(std::istream &input)
+    void NodeBuilder::StartDict()
+    {
+        dicts_.emplace_back();
+        in_dict_.push_back(true);
+    }
+
+    void NodeBuilder::Key(std::string key)
+    {
+        // try_emplace leaves the key untouched when it is already there
+        const auto [it, inserted] = dicts_.back().try_emplace(std::move(key));
+        if (!inserted)
         {
-            char c;
-            if (!(input >> c))
-            {
-                throw ParsingError("Unexpected EOF"s);
-            }
-            switch (c)
-            {
-            case '[':
-                return LoadArray(input);
-            case '{':
-                return LoadDict(input);
-            case '"':
-                return LoadString(input);
-            case 't':
-                [[fallthrough]];
-            case 'f':
-                input.putback(c);
-                return LoadBool(input);
-            case 'n':
-                input.putback(c);
-                return LoadNull(input);
-            default:
-                input.putback(c);
-                return LoadNumber(input);
-            }
+            throw ParsingError("Duplicate key '"s + key + "' have been found");
         }
+        keys_.push_back(it);
+    }
 
-        struct PrintContext
+    void NodeBuilder::EndDict()
+    {
+        Node dict(std::move(dicts_.back()));
+        dicts_.pop_back();
+        in_dict_.pop_back();
+        Value(std::move(dict));
+    }
+
+    void NodeBuilder::Value(Node value)
+    {
+        if (in_dict_.empty())
+        {
+            root_ = std::move(value);
+        }
+        else if (!in_dict_.back())
+        {
+            arrays_.back().push_back(std::move(value));
+        }
+        else
         {
-            std::ostream &out;
-            int indent_step = 4;
-            int indent = 0;
+            keys_.back()->second = std::move(value);
+            keys_.pop_back();
+        }
+    }
 
-            void PrintIndent() const
-            {
-                for (int i = 0; i < indent; ++i)
-                {
-                    out.put(' ');
-                }
-            }
+    Node NodeBuilder::Extract()
+    {
+        return std::move(root_);
+    }
 
-            PrintContext Indented() const
-            {
-                return {out, indent_step, indent_step + indent};
-            }
-        };
+    Document Load(std::string_view input)
+    {
+        NodeBuilder builder;
+        Parser(input, builder).ParseNode();
+        return Document{builder.Extract()};
+    }
+
+    Document Load(std::istream &input)
+    {
+        return Load(ReadAll(input));
+    }
+
+    void Parse(std::string_view input, Handler &handler)
+    {
+        Parser(input, handler).ParseNode();
+    }
+
+    void Parse(std::istream &input, Handler &handler)
+    {
+        Parse(ReadAll(input), handler);
+    }
+
+    Writer::Writer(std::ostream &output, PrintMode mode)
+        : buffer_(output), mode_(mode)
+    {
+    }
 
-        void PrintNode(const Node &value, const PrintContext &ctx);
+    void Writer::StartArray()
+    {
+        BeginValue();
+        StartContainer('[', false);
+    }
 
-        template <typename Value>
-        void PrintValue(const Value &value, const PrintContext &ctx)
+    void Writer::EndArray()
+    {
+        EndContainer(']', false);
+    }
+
+    void Writer::StartDict()
+    {
+        BeginValue();
+        StartContainer('{', true);
+    }
+
+    void Writer::Key(std::string_view key)
+    {
+        if (containers_.empty() || !containers_.back().is_dict || after_key_)
         {
-            ctx.out << value;
+            throw std::logic_error("Invalid call to the \"Key\" method"s);
         }
+        BeginElement();
+        WriteString(key);
+        buffer_ << (mode_ == PrintMode::INDENTED ? ": "sv : ":"sv);
+        after_key_ = true;
+    }
 
-        void PrintString(const std::string &value, std::ostream &out)
+    void Writer::EndDict()
+    {
+        EndContainer('}', true);
+    }
+
+    void Writer::Value(const Node &node)
+    {
+        std::visit(
+            [this](const auto &value)
+            {
+                WriteValue(value);
+            },
+            node.GetValue());
+    }
+
+    void Writer::String(std::string_view value)
+    {
+        BeginValue();
+        WriteString(value);
+    }
+
+    void Writer::Flush()
+    {
+        buffer_.Flush();
+    }
+
+    void Writer::WriteString(std::string_view value)
+    {
+        buffer_ << '"';
+        size_t run_begin = 0;
+        for (size_t i = 0; i < value.size(); ++i)
         {
-            out.put('"');
-            for (const char c : value)
+            const char c = value[i];
+            if (c != '\r' && c != '\n' && c != '"' && c != '\\')
             {
-                switch (c)
-                {
-                case '\r':
-                    out << "\\r"sv;
-                    break;
-                case '\n':
-                    out << "\\n"sv;
-                    break;
-                case '"':
-                    [[fallthrough]];
-                case '\\':
-                    out.put('\\');
-                    [[fallthrough]];
-                default:
-                    out.put(c);
-                    break;
-                }
+                continue;
+            }
+            buffer_ << value.substr(run_begin, i - run_begin);
+            switch (c)
+            {
+            case '\r':
+                buffer_ << "\\r"sv;
+                break;
+            case '\n':
+                buffer_ << "\\n"sv;
+                break;
+            default:
+                buffer_ << '\\' << c;
+                break;
             }
-            out.put('"');
+            run_begin = i + 1;
         }
+        buffer_ << value.substr(run_begin) << '"';
+    }
 
-        template <>
-        void PrintValue<std::string>(const std::string &value, const PrintContext &ctx)
+    void Writer::WriteValue(std::nullptr_t)
+    {
+        BeginValue();
+        buffer_ << "null"sv;
+    }
+
+    void Writer::WriteValue(const Array &nodes)
+    {
+        StartArray();
+        for (const Node &node : nodes)
         {
-            PrintString(value, ctx.out);
+            Value(node);
         }
+        EndArray();
+    }
 
-        template <>
-        void PrintValue<std::nullptr_t>(const std::nullptr_t &, const PrintContext &ctx)
+    void Writer::WriteValue(const Dict &nodes)
+    {
+        StartDict();
+        for (const auto &[key, node] : nodes)
         {
-            ctx.out << "null"sv;
+            Key(key);
+            Value(node);
         }
+        EndDict();
+    }
+
+    void Writer::WriteValue(bool value)
+    {
+        BeginValue();
+        buffer_ << (value ? "true"sv : "false"sv);
+    }
+
+    void Writer::WriteValue(int value)
+    {
+        BeginValue();
+        buffer_ << value;
+    }
+
+    void Writer::WriteValue(double value)
+    {
+        BeginValue();
+        buffer_ << value;
+    }
 
-        template <>
-        void PrintValue<bool>(const bool &value, const PrintContext &ctx)
+    void Writer::WriteValue(const std::string &value)
+    {
+        String(value);
+    }
+
+    void Writer::BeginValue()
+    {
+        if (after_key_)
         {
-            ctx.out << (value ? "true"sv : "false"sv);
+            after_key_ = false;
+            return;
         }
-
-        template <>
-        void PrintValue<Array>(const Array &nodes, const PrintContext &ctx)
+        if (containers_.empty())
         {
-            std::ostream &out = ctx.out;
-            out << "[\n"sv;
-            bool first = true;
-            auto inner_ctx = ctx.Indented();
-            for (const Node &node : nodes)
-            {
-                if (first)
-                {
-                    first = false;
-                }
-                else
-                {
-                    out << ",\n"sv;
-                }
-                inner_ctx.PrintIndent();
-                PrintNode(node, inner_ctx);
-            }
-            out.put('\n');
-            ctx.PrintIndent();
-            out.put(']');
+            return;
         }
-
-        template <>
-        void PrintValue<Dict>(const Dict &nodes, const PrintContext &ctx)
+        if (containers_.back().is_dict)
         {
-            std::ostream &out = ctx.out;
-            out << "{\n"sv;
-            bool first = true;
-            auto inner_ctx = ctx.Indented();
-            for (const auto &[key, node] : nodes)
-            {
-                if (first)
-                {
-                    first = false;
-                }
-                else
-                {
-                    out << ",\n"sv;
-                }
-                inner_ctx.PrintIndent();
-                PrintString(key, ctx.out);
-                out << ": "sv;
-                PrintNode(node, inner_ctx);
-            }
-            out.put('\n');
-            ctx.PrintIndent();
-            out.put('}');
+            throw std::logic_error("Invalid call to the \"Value\" method"s);
         }
+        BeginElement();
+    }
 
-        void PrintNode(const Node &node, const PrintContext &ctx)
+    void Writer::BeginElement()
+    {
+        if (containers_.back().has_elements)
         {
-            std::visit(
-                [&ctx](const auto &value)
-                {
-                    PrintValue(value, ctx);
-                },
-                node.GetValue());
+            buffer_ << ',';
+        }
+        containers_.back().has_elements = true;
+        if (mode_ == PrintMode::INDENTED)
+        {
+            buffer_ << '\n';
+            buffer_.Fill(' ', containers_.size() * INDENT_STEP);
         }
     }
 
-    Document Load(std::istream &input)
+    void Writer::StartContainer(char bracket, bool is_dict)
+    {
+        containers_.push_back({is_dict, false});
+        buffer_ << bracket;
+    }
+
+    void Writer::EndContainer(char bracket, bool is_dict)
     {
-        return Document{LoadNode(input)};
+        if (containers_.empty() || containers_.back().is_dict != is_dict || after_key_)
+        {
+            throw std::logic_error(is_dict ? "Invalid call to the \"EndDict\" method"s : "Invalid call to the \"EndArray\" method"s);
+        }
+        const bool has_elements = containers_.back().has_elements;
+        containers_.pop_back();
+        if (mode_ == PrintMode::INDENTED)
+        {
+            // an empty container keeps the blank line of the former printer
+            buffer_ << (has_elements ? "\n"sv : "\n\n"sv);
+            buffer_.Fill(' ', containers_.size() * INDENT_STEP);
+        }
+        buffer_ << bracket;
     }
 
-    void Print(const Document &doc, std::ostream &output)
+    void Print(const Document &doc, std::ostream &output, PrintMode mode)
     {
-        PrintNode(doc.GetRoot(), PrintContext{output});
+        Writer(output, mode).Value(doc.GetRoot());
     }
 }
\ No newline at end of file
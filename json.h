@@ -3,9 +3,12 @@
 #include <iostream>
 #include <map>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
+#include "output_buffer.h"
+
 namespace json
 {
     class Node;
@@ -172,8 +175,139 @@ namespace json
         return !(lhs == rhs);
     }
 
+    // Receives a document event by event, in the order of the input. The value of a dictionary key comes
+    // right after the key, a nested array or dictionary is reported between its start and its end
+    class Handler
+    {
+    public:
+        virtual ~Handler() = default;
+
+        virtual void StartArray() = 0;
+
+        virtual void EndArray() = 0;
+
+        virtual void StartDict() = 0;
+
+        virtual void Key(std::string key) = 0;
+
+        virtual void EndDict() = 0;
+
+        // null, bool, number or string
+        virtual void Value(Node value) = 0;
+    };
+
+    // Assembles the events of one value into a node
+    class NodeBuilder final : public Handler
+    {
+    public:
+        void StartArray() override;
+
+        void EndArray() override;
+
+        void StartDict() override;
+
+        void Key(std::string key) override;
+
+        void EndDict() override;
+
+        void Value(Node value) override;
+
+        // The assembled value, once its last event has been received
+        Node Extract();
+
+    private:
+        // the open containers, innermost last; keys_ point to the entries waiting for a value
+        std::vector<Array> arrays_;
+        std::vector<Dict> dicts_;
+        std::vector<bool> in_dict_;
+        std::vector<Dict::iterator> keys_;
+        Node root_;
+    };
+
+    // The whole input is parsed from one contiguous buffer, e.g. a file read at once or mapped to memory
+    Document Load(std::string_view input);
+
     Document Load(std::istream &input);
 
-    void Print(const Document &doc, std::ostream &output);
+    // Reports the document to the handler instead of building it; duplicate keys are left to the handler
+    void Parse(std::string_view input, Handler &handler);
+
+    void Parse(std::istream &input, Handler &handler);
+
+    enum class PrintMode
+    {
+        INDENTED,
+        COMPACT,
+    };
+
+    // Writes a document piece by piece through a buffer, so it does not have to be built in memory first.
+    // Pretty-printed text is the same as the one of Print
+    class Writer
+    {
+    public:
+        explicit Writer(std::ostream &output, PrintMode mode = PrintMode::INDENTED);
+
+        Writer(const Writer &) = delete;
+
+        Writer &operator=(const Writer &) = delete;
+
+        void StartArray();
+
+        void EndArray();
+
+        void StartDict();
+
+        void Key(std::string_view key);
+
+        void EndDict();
+
+        void Value(const Node &node);
+
+        // A string value which does not have to be copied into a node
+        void String(std::string_view value);
+
+        // Passes the buffered text to the stream
+        void Flush();
+
+    private:
+        static constexpr size_t INDENT_STEP = 4;
+
+        struct Container
+        {
+            bool is_dict = false;
+            bool has_elements = false;
+        };
+
+        output::Buffer buffer_;
+        PrintMode mode_;
+        std::vector<Container> containers_;
+        bool after_key_ = false;
+
+        void WriteString(std::string_view value);
+
+        void WriteValue(std::nullptr_t);
+
+        void WriteValue(const Array &nodes);
+
+        void WriteValue(const Dict &nodes);
+
+        void WriteValue(bool value);
+
+        void WriteValue(int value);
+
+        void WriteValue(double value);
+
+        void WriteValue(const std::string &value);
+
+        void BeginValue();
+
+        void BeginElement();
+
+        void StartContainer(char bracket, bool is_dict);
+
+        void EndContainer(char bracket, bool is_dict);
+    };
+
+    void Print(const Document &doc, std::ostream &output, PrintMode mode = PrintMode::INDENTED);
 
 }
\ No newline at end of file
@@ -10,14 +10,15 @@ namespace json
     class StartDictContext;
     class StartArrayContext;
 
+    // Appends every value in place into the containers being built
     class Builder
     {
     public:
         Builder() = default;
 
-        virtual DictKeyContext Key(std::string &key);
+        DictKeyContext Key(std::string key);
 
-        Builder Value(const Node::Value &value);
+        Builder &Value(Node value);
 
         StartDictContext StartDict();
 
@@ -27,19 +28,23 @@ namespace json
 
         Builder &EndArray();
 
-        Node &Build();
+        // Hands the completed node over, the builder is left empty
+        Node Build();
 
     private:
-        std::vector<Node> nodes_stack_;
-        std::vector<std::string> keys;
-        int number_unclosed_containers = 0;
-        std::string last_command;
-        bool object_completed = false;
-        bool command_permission_to_insert = true;
+        // what may come next
+        enum class State
+        {
+            VALUE,
+            KEY,
+            COMPLETED,
+        };
 
-        void EndContainer();
+        NodeBuilder nodes_;
+        std::vector<bool> in_dict_;
+        State state_ = State::VALUE;
 
-        Node GetValue(const Node::Value &value);
+        void EndValue();
     };
 
     class DictValueContext
@@ -66,7 +71,7 @@ namespace json
         {
         }
 
-        ArrayValueContext Value(const Node::Value &value);
+        ArrayValueContext Value(Node value);
 
         StartDictContext StartDict();
 
@@ -86,7 +91,7 @@ namespace json
         {
         }
 
-        DictValueContext Value(const Node::Value &value);
+        DictValueContext Value(Node value);
 
         StartDictContext StartDict();
 
@@ -120,7 +125,7 @@ namespace json
         {
         }
 
-        ArrayValueContext Value(const Node::Value &value);
+        ArrayValueContext Value(Node value);
 
         StartDictContext StartDict();
 
@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <cstring>
+
+#include "json_flat.h"
+
+namespace json
+{
+    using namespace std::literals;
+
+    void *Arena::Allocate(size_t size, size_t alignment)
+    {
+        size_t padding = (alignment - reinterpret_cast<uintptr_t>(position_) % alignment) % alignment;
+        if (padding + size > left_)
+        {
+            // a large request gets a block of its own, the current block stays in use
+            if (size > BLOCK_SIZE / 4)
+            {
+                blocks_.push_back(std::make_unique<char[]>(size));
+                return blocks_.back().get();
+            }
+            blocks_.push_back(std::make_unique<char[]>(BLOCK_SIZE));
+            position_ = blocks_.back().get();
+            left_ = BLOCK_SIZE;
+            padding = 0;
+        }
+        void *result = position_ + padding;
+        position_ += padding + size;
+        left_ -= padding + size;
+        return result;
+    }
+
+    std::string_view Arena::CopyString(std::string_view value)
+    {
+        char *copy = Allocate<char>(value.size());
+        std::memcpy(copy, value.data(), value.size());
+        return {copy, value.size()};
+    }
+
+    const FlatMember *FlatDict::find(std::string_view key) const
+    {
+        const FlatMember *member = std::lower_bound(begin(), end(), key,
+                                                    [](const FlatMember &member, std::string_view key)
+                                                    {
+                                                        return member.first < key;
+                                                    });
+        return member != end() && member->first == key ? member : end();
+    }
+
+    size_t FlatDict::count(std::string_view key) const
+    {
+        return find(key) != end() ? 1 : 0;
+    }
+
+    const FlatNode &FlatDict::at(std::string_view key) const
+    {
+        const FlatMember *member = find(key);
+        if (member == end())
+        {
+            throw std::out_of_range("No key '"s + std::string(key) + "'"s);
+        }
+        return member->second;
+    }
+
+    void FlatBuilder::StartArray()
+    {
+        containers_.push_back({false, elements_.size()});
+    }
+
+    void FlatBuilder::EndArray()
+    {
+        const size_t first = containers_.back().first;
+        const size_t size = elements_.size() - first;
+        FlatNode *nodes = arena_.Allocate<FlatNode>(size);
+        std::copy(elements_.begin() + first, elements_.end(), nodes);
+        elements_.resize(first);
+        containers_.pop_back();
+
+        FlatNode node;
+        node.type_ = FlatNode::Type::ARRAY;
+        node.size_ = static_cast<uint32_t>(size);
+        node.array_ = nodes;
+        Place(node);
+    }
+
+    void FlatBuilder::StartDict()
+    {
+        containers_.push_back({true, members_.size()});
+    }
+
+    void FlatBuilder::Key(std::string key)
+    {
+        members_.push_back({arena_.CopyString(key), {}});
+    }
+
+    void FlatBuilder::EndDict()
+    {
+        const size_t first = containers_.back().first;
+        const size_t size = members_.size() - first;
+        std::sort(members_.begin() + first, members_.end(),
+                  [](const FlatMember &lhs, const FlatMember &rhs)
+                  {
+                      return lhs.first < rhs.first;
+                  });
+        const auto duplicate = std::adjacent_find(members_.begin() + first, members_.end(),
+                                                  [](const FlatMember &lhs, const FlatMember &rhs)
+                                                  {
+                                                      return lhs.first == rhs.first;
+                                                  });
+        if (duplicate != members_.end())
+        {
+            throw ParsingError("Duplicate key '"s + std::string(duplicate->first) + "' have been found");
+        }
+        FlatMember *members = arena_.Allocate<FlatMember>(size);
+        std::copy(members_.begin() + first, members_.end(), members);
+        members_.resize(first);
+        containers_.pop_back();
+
+        FlatNode node;
+        node.type_ = FlatNode::Type::DICT;
+        node.size_ = static_cast<uint32_t>(size);
+        node.dict_ = members;
+        Place(node);
+    }
+
+    void FlatBuilder::Value(Node value)
+    {
+        FlatNode node;
+        if (value.IsArray())
+        {
+            StartArray();
+            for (const Node &element : value.AsArray())
+            {
+                Value(element);
+            }
+            EndArray();
+            return;
+        }
+        else if (value.IsDict())
+        {
+            StartDict();
+            for (const auto &[key, element] : value.AsDict())
+            {
+                Key(key);
+                Value(element);
+            }
+            EndDict();
+            return;
+        }
+        else if (value.IsBool())
+        {
+            node.type_ = FlatNode::Type::BOOL;
+            node.bool_ = value.AsBool();
+        }
+        else if (value.IsInt())
+        {
+            node.type_ = FlatNode::Type::INT;
+            node.int_ = value.AsInt();
+        }
+        else if (value.IsPureDouble())
+        {
+            node.type_ = FlatNode::Type::DOUBLE;
+            node.double_ = value.AsDouble();
+        }
+        else if (value.IsString())
+        {
+            const std::string_view string = arena_.CopyString(value.AsString());
+            node.type_ = FlatNode::Type::STRING;
+            node.size_ = static_cast<uint32_t>(string.size());
+            node.string_ = string.data();
+        }
+        Place(node);
+    }
+
+    FlatDocument FlatBuilder::Extract()
+    {
+        FlatDocument document(std::move(arena_), root_);
+        arena_ = Arena();
+        root_ = FlatNode();
+        return document;
+    }
+
+    void FlatBuilder::Place(const FlatNode &node)
+    {
+        if (containers_.empty())
+        {
+            root_ = node;
+        }
+        else if (containers_.back().is_dict)
+        {
+            members_.back().second = node;
+        }
+        else
+        {
+            elements_.push_back(node);
+        }
+    }
+}
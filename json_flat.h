@@ -0,0 +1,329 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "json.h"
+
+namespace json
+{
+    // Hands out memory in large blocks which are all freed together with the arena
+    class Arena
+    {
+    public:
+        Arena() = default;
+
+        Arena(Arena &&) = default;
+
+        Arena &operator=(Arena &&) = default;
+
+        // Only for trivially destructible types: nothing allocated here is ever destroyed
+        template <typename T>
+        T *Allocate(size_t count)
+        {
+            static_assert(std::is_trivially_destructible_v<T>);
+            return static_cast<T *>(Allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        std::string_view CopyString(std::string_view value);
+
+    private:
+        static constexpr size_t BLOCK_SIZE = 1 << 16;
+
+        std::vector<std::unique_ptr<char[]>> blocks_;
+        char *position_ = nullptr;
+        size_t left_ = 0;
+
+        void *Allocate(size_t size, size_t alignment);
+    };
+
+    class FlatNode;
+    struct FlatMember;
+
+    class FlatArray
+    {
+    public:
+        FlatArray() = default;
+
+        FlatArray(const FlatNode *nodes, size_t size)
+            : nodes_(nodes), size_(size)
+        {
+        }
+
+        const FlatNode *begin() const
+        {
+            return nodes_;
+        }
+
+        const FlatNode *end() const;
+
+        size_t size() const
+        {
+            return size_;
+        }
+
+        bool empty() const
+        {
+            return size_ == 0;
+        }
+
+        const FlatNode &operator[](size_t index) const;
+
+    private:
+        const FlatNode *nodes_ = nullptr;
+        size_t size_ = 0;
+    };
+
+    // Members are sorted by key, lookups are binary searches
+    class FlatDict
+    {
+    public:
+        FlatDict() = default;
+
+        FlatDict(const FlatMember *members, size_t size)
+            : members_(members), size_(size)
+        {
+        }
+
+        const FlatMember *begin() const
+        {
+            return members_;
+        }
+
+        const FlatMember *end() const;
+
+        size_t size() const
+        {
+            return size_;
+        }
+
+        bool empty() const
+        {
+            return size_ == 0;
+        }
+
+        const FlatMember *find(std::string_view key) const;
+
+        size_t count(std::string_view key) const;
+
+        const FlatNode &at(std::string_view key) const;
+
+    private:
+        const FlatMember *members_ = nullptr;
+        size_t size_ = 0;
+    };
+
+    // Read-only counterpart of Node: strings, arrays and dictionaries refer to the memory of an arena
+    class FlatNode
+    {
+    public:
+        FlatNode() = default;
+
+        bool IsNull() const
+        {
+            return type_ == Type::NULL_VALUE;
+        }
+
+        bool IsArray() const
+        {
+            return type_ == Type::ARRAY;
+        }
+
+        bool IsDict() const
+        {
+            return type_ == Type::DICT;
+        }
+
+        bool IsBool() const
+        {
+            return type_ == Type::BOOL;
+        }
+
+        bool IsInt() const
+        {
+            return type_ == Type::INT;
+        }
+
+        bool IsPureDouble() const
+        {
+            return type_ == Type::DOUBLE;
+        }
+
+        bool IsDouble() const
+        {
+            return IsInt() || IsPureDouble();
+        }
+
+        bool IsString() const
+        {
+            return type_ == Type::STRING;
+        }
+
+        FlatArray AsArray() const
+        {
+            using namespace std::literals;
+            if (!IsArray())
+            {
+                throw std::logic_error("Not an array"s);
+            }
+            return {array_, size_};
+        }
+
+        FlatDict AsDict() const
+        {
+            using namespace std::literals;
+            if (!IsDict())
+            {
+                throw std::logic_error("Not a dict"s);
+            }
+            return {dict_, size_};
+        }
+
+        bool AsBool() const
+        {
+            using namespace std::literals;
+            if (!IsBool())
+            {
+                throw std::logic_error("Not a bool"s);
+            }
+            return bool_;
+        }
+
+        int AsInt() const
+        {
+            using namespace std::literals;
+            if (!IsInt())
+            {
+                throw std::logic_error("Not an int"s);
+            }
+            return int_;
+        }
+
+        double AsDouble() const
+        {
+            using namespace std::literals;
+            if (!IsDouble())
+            {
+                throw std::logic_error("Not a double"s);
+            }
+            return IsPureDouble() ? double_ : int_;
+        }
+
+        std::string_view AsString() const
+        {
+            using namespace std::literals;
+            if (!IsString())
+            {
+                throw std::logic_error("Not a string"s);
+            }
+            return {string_, size_};
+        }
+
+    private:
+        friend class FlatBuilder;
+
+        enum class Type : uint8_t
+        {
+            NULL_VALUE,
+            ARRAY,
+            DICT,
+            BOOL,
+            INT,
+            DOUBLE,
+            STRING,
+        };
+
+        Type type_ = Type::NULL_VALUE;
+        uint32_t size_ = 0;
+        union
+        {
+            const FlatNode *array_;
+            const FlatMember *dict_;
+            const char *string_;
+            bool bool_;
+            int int_;
+            double double_ = 0;
+        };
+    };
+
+    struct FlatMember
+    {
+        std::string_view first;
+        FlatNode second;
+    };
+
+    inline const FlatNode *FlatArray::end() const
+    {
+        return nodes_ + size_;
+    }
+
+    inline const FlatNode &FlatArray::operator[](size_t index) const
+    {
+        return nodes_[index];
+    }
+
+    inline const FlatMember *FlatDict::end() const
+    {
+        return members_ + size_;
+    }
+
+    class FlatDocument
+    {
+    public:
+        FlatDocument() = default;
+
+        FlatDocument(Arena arena, FlatNode root)
+            : arena_(std::move(arena)), root_(root)
+        {
+        }
+
+        const FlatNode &GetRoot() const
+        {
+            return root_;
+        }
+
+    private:
+        Arena arena_;
+        FlatNode root_;
+    };
+
+    // Assembles the events of one value into a flat document. Elements of the open containers wait in shared
+    // stacks and are copied to the arena in one piece when their container ends
+    class FlatBuilder final : public Handler
+    {
+    public:
+        void StartArray() override;
+
+        void EndArray() override;
+
+        void StartDict() override;
+
+        void Key(std::string key) override;
+
+        void EndDict() override;
+
+        void Value(Node value) override;
+
+        // The assembled document, once its last event has been received
+        FlatDocument Extract();
+
+    private:
+        struct Container
+        {
+            bool is_dict = false;
+            size_t first = 0;
+        };
+
+        Arena arena_;
+        std::vector<Container> containers_;
+        std::vector<FlatNode> elements_;
+        std::vector<FlatMember> members_;
+        FlatNode root_;
+
+        void Place(const FlatNode &node);
+    };
+}
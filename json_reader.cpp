@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 
 #include "json_reader.h"
@@ -6,45 +7,309 @@ namespace reader
 {
     using namespace std::string_literals;
 
+    // Keeps the sections of the root dictionary as nodes, stat_requests as a flat document. Base requests are
+    // assembled one by one and go to the catalogue right away. Distances and buses referring to stops which have not been seen yet
+    // wait in the pending lists until the end of base_requests
+    class JsonReader::DataBaseHandler final : public json::Handler
+    {
+    public:
+        explicit DataBaseHandler(JsonReader &reader)
+            : reader_(reader)
+        {
+        }
+
+        void StartArray() override
+        {
+            if (depth_ == 1 && section_ == "base_requests"s)
+            {
+                in_base_requests_ = true;
+                ++depth_;
+                return;
+            }
+            CheckRoot();
+            SectionBuilder().StartArray();
+            ++depth_;
+        }
+
+        void EndArray() override
+        {
+            --depth_;
+            if (depth_ == 1 && in_base_requests_)
+            {
+                in_base_requests_ = false;
+                AddPendingRequests();
+                return;
+            }
+            SectionBuilder().EndArray();
+            OnValueEnd();
+        }
+
+        void StartDict() override
+        {
+            if (depth_ > 0)
+            {
+                SectionBuilder().StartDict();
+            }
+            ++depth_;
+        }
+
+        void Key(std::string key) override
+        {
+            if (depth_ != 1)
+            {
+                SectionBuilder().Key(std::move(key));
+                return;
+            }
+            if (!sections_.try_emplace(key).second)
+            {
+                throw json::ParsingError("Duplicate key '"s + key + "' have been found");
+            }
+            in_stat_requests_ = key == "stat_requests"s;
+            section_ = std::move(key);
+        }
+
+        void EndDict() override
+        {
+            --depth_;
+            if (depth_ == 0)
+            {
+                sections_.erase("base_requests"s);
+                sections_.erase("stat_requests"s);
+                reader_.json_data_base_ = std::move(sections_);
+                return;
+            }
+            SectionBuilder().EndDict();
+            OnValueEnd();
+        }
+
+        void Value(json::Node value) override
+        {
+            CheckRoot();
+            SectionBuilder().Value(std::move(value));
+            OnValueEnd();
+        }
+
+    private:
+        JsonReader &reader_;
+        int depth_ = 0;
+        json::Dict sections_;
+        std::string section_;
+        bool in_base_requests_ = false;
+        bool in_stat_requests_ = false;
+        json::NodeBuilder builder_;
+        json::FlatBuilder flat_builder_;
+        std::vector<domain::StopInputInfo> pending_distances_;
+        std::vector<domain::BusInputInfo> pending_buses_;
+
+        void CheckRoot() const
+        {
+            if (depth_ == 0)
+            {
+                throw std::logic_error("Not a dict"s);
+            }
+        }
+
+        json::Handler &SectionBuilder()
+        {
+            if (in_stat_requests_)
+            {
+                return flat_builder_;
+            }
+            return builder_;
+        }
+
+        void OnValueEnd()
+        {
+            if (depth_ == 1 && in_stat_requests_)
+            {
+                reader_.stat_requests_ = flat_builder_.Extract();
+            }
+            else if (depth_ == 1)
+            {
+                sections_.at(section_) = builder_.Extract();
+            }
+            else if (depth_ == 2 && in_base_requests_)
+            {
+                AddRequest(builder_.Extract());
+            }
+        }
+
+        bool HasStop(const std::string &name) const
+        {
+            return reader_.transport_catalogue_.FindStopId(name).has_value();
+        }
+
+        void AddRequest(const json::Node &request)
+        {
+            catalogue::TransportCatalogue &transport_catalogue = reader_.transport_catalogue_;
+            const std::string &type = request.AsDict().at("type"s).AsString();
+            if (type == "Stop"s)
+            {
+                transport_catalogue.AddStop(reader_.ReadStopInputInfo(request));
+                domain::StopInputInfo distances = reader_.ReadDistanceInputInfo(request);
+                domain::StopInputInfo pending;
+                for (auto it = distances.distance_to_other_stops.begin(); it != distances.distance_to_other_stops.end();)
+                {
+                    if (HasStop(it->first))
+                    {
+                        ++it;
+                        continue;
+                    }
+                    pending.distance_to_other_stops.insert(distances.distance_to_other_stops.extract(it++));
+                }
+                transport_catalogue.AddDistanceBetweenStop(distances);
+                if (!pending.distance_to_other_stops.empty())
+                {
+                    pending.name_stop = std::move(distances.name_stop);
+                    pending_distances_.push_back(std::move(pending));
+                }
+            }
+            else if (type == "Bus"s)
+            {
+                domain::BusInputInfo bus = reader_.ReadBusInputInfo(request);
+                const bool all_stops_seen = std::all_of(bus.stops.begin(), bus.stops.end(),
+                                                        [this](const std::string &stop)
+                                                        {
+                                                            return HasStop(stop);
+                                                        });
+                if (all_stops_seen)
+                {
+                    transport_catalogue.AddBus(bus);
+                }
+                else
+                {
+                    pending_buses_.push_back(std::move(bus));
+                }
+            }
+        }
+
+        void AddPendingRequests()
+        {
+            for (const domain::StopInputInfo &distances : pending_distances_)
+            {
+                reader_.transport_catalogue_.AddDistanceBetweenStop(distances);
+            }
+            for (const domain::BusInputInfo &bus : pending_buses_)
+            {
+                reader_.transport_catalogue_.AddBus(bus);
+            }
+            pending_distances_.clear();
+            pending_distances_.shrink_to_fit();
+            pending_buses_.clear();
+            pending_buses_.shrink_to_fit();
+        }
+    };
+
     JsonReader::JsonReader(std::istream &input)
-        : json_data_base_(json::Load(input).GetRoot())
     {
+        DataBaseHandler handler(*this);
+        json::Parse(input, handler);
     }
 
     catalogue::TransportCatalogue JsonReader::CreateTransportCatalogue()
     {
-        catalogue::TransportCatalogue transport_catalogue;
-        auto base_requests = json_data_base_.AsDict().at("base_requests"s).AsArray();
+        return std::move(transport_catalogue_);
+    }
 
-        for (const auto &request : base_requests)
+    domain::CatalogueChanges JsonReader::ApplyPatchRequests(catalogue::TransportCatalogue &transport_catalogue)
+    {
+        const json::Array &requests = json_data_base_.AsDict().at("patch_requests"s).AsArray();
+        auto find_stop = [&transport_catalogue](const std::string &name)
         {
-            if (request.AsDict().at("type"s).AsString() == "Stop"s)
+            const auto id = transport_catalogue.FindStopId(name);
+            if (!id)
+            {
+                throw std::out_of_range("Unknown stop: "s + name);
+            }
+            return *id;
+        };
+        auto is_removed = [](const json::Dict &request)
+        {
+            const auto removed = request.find("removed"s);
+            return removed != request.end() && removed->second.AsBool();
+        };
+        auto is_stop = [&is_removed](const json::Node &request, bool removed)
+        {
+            return request.AsDict().at("type"s).AsString() == "Stop"s && is_removed(request.AsDict()) == removed;
+        };
+
+        domain::CatalogueChanges changes;
+        for (const json::Node &request : requests)
+        {
+            if (!is_stop(request, false))
+            {
+                continue;
+            }
+            const auto id = transport_catalogue.FindStopId(request.AsDict().at("name"s).AsString());
+            if (!id || request.AsDict().count("latitude"s))
             {
                 transport_catalogue.AddStop(ReadStopInputInfo(request));
             }
+            if (id && request.AsDict().count("latitude"s))
+            {
+                changes.stops.push_back(*id);
+            }
         }
-
-        for (const auto &request : base_requests)
+        for (const json::Node &request : requests)
         {
-            if (request.AsDict().at("type"s).AsString() == "Stop"s)
+            if (!is_stop(request, false))
+            {
+                continue;
+            }
+            const json::Dict &stop = request.AsDict();
+            const domain::StopId id = find_stop(stop.at("name"s).AsString());
+            if (stop.count("road_distances"s))
             {
                 transport_catalogue.AddDistanceBetweenStop(ReadDistanceInputInfo(request));
+                changes.stops.push_back(id);
+            }
+            if (stop.count("removed_road_distances"s))
+            {
+                for (const json::Node &other_stop : stop.at("removed_road_distances"s).AsArray())
+                {
+                    transport_catalogue.RemoveDistanceBetweenStops(id, find_stop(other_stop.AsString()));
+                }
+                changes.stops.push_back(id);
             }
         }
-
-        for (const auto &request : base_requests)
+        for (const json::Node &request : requests)
         {
-            if (request.AsDict().at("type"s).AsString() == "Bus"s)
+            const json::Dict &bus = request.AsDict();
+            if (bus.at("type"s).AsString() != "Bus"s)
+            {
+                continue;
+            }
+            if (!is_removed(bus))
             {
-                transport_catalogue.AddBus(ReadBusInputInfo(request));
+                changes.buses.push_back(transport_catalogue.AddBus(ReadBusInputInfo(request)));
+                continue;
             }
+            const std::string &name = bus.at("name"s).AsString();
+            const auto id = transport_catalogue.FindBusId(name);
+            if (!id)
+            {
+                throw std::out_of_range("Unknown bus: "s + name);
+            }
+            transport_catalogue.RemoveBus(*id);
+            changes.buses.push_back(*id);
         }
-        return transport_catalogue;
+        for (const json::Node &request : requests)
+        {
+            if (is_stop(request, true))
+            {
+                transport_catalogue.RemoveStop(find_stop(request.AsDict().at("name"s).AsString()));
+            }
+        }
+        return changes;
     }
 
-    const json::Node &JsonReader::GetStatRequest() const
+    const json::FlatNode &JsonReader::GetStatRequest() const
     {
-        return json_data_base_.AsDict().at("stat_requests"s);
+        if (!stat_requests_)
+        {
+            throw std::out_of_range("No stat_requests"s);
+        }
+        return stat_requests_->GetRoot();
     }
 
     const json::Node &JsonReader::GetRenderSettings() const
@@ -62,6 +327,26 @@ namespace reader
         return json_data_base_.AsDict().at("serialization_settings"s);
     }
 
+    json::PrintMode JsonReader::GetPrintMode() const
+    {
+        const json::Dict &sections = json_data_base_.AsDict();
+        const auto output_settings = sections.find("output_settings"s);
+        if (output_settings == sections.end() || !output_settings->second.AsDict().count("format"s))
+        {
+            return json::PrintMode::INDENTED;
+        }
+        const std::string &format = output_settings->second.AsDict().at("format"s).AsString();
+        if (format == "indented"s)
+        {
+            return json::PrintMode::INDENTED;
+        }
+        else if (format == "compact"s)
+        {
+            return json::PrintMode::COMPACT;
+        }
+        throw std::invalid_argument("Unknown output format: "s + format);
+    }
+
     domain::StopInputInfo JsonReader::ReadStopInputInfo(const json::Node &request)
     {
         domain::StopInputInfo stop_info;
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <optional>
+
+#include "json_flat.h"
 #include "request_handler.h"
 
 namespace reader
@@ -9,9 +12,15 @@ namespace reader
     public:
         JsonReader(std::istream &input);
 
+        // The catalogue is filled while base_requests are parsed and is handed over to the caller
         catalogue::TransportCatalogue CreateTransportCatalogue();
 
-        const json::Node &GetStatRequest() const;
+        // patch_requests of update_base: "Stop" adds a stop or changes the coordinates and the road distances of an existing one,
+        // "removed_road_distances" lists the stops whose distances from it are removed; "Bus" adds or replaces a bus. Either
+        // is removed by "removed": true. Stops go first, then distances, buses and the removal of stops
+        domain::CatalogueChanges ApplyPatchRequests(catalogue::TransportCatalogue &transport_catalogue);
+
+        const json::FlatNode &GetStatRequest() const;
 
         const json::Node &GetRenderSettings() const;
 
@@ -19,8 +28,16 @@ namespace reader
 
         const json::Node &GetSerializationSettings() const;
 
+        // "format" of the optional output_settings: "indented" (the default) or "compact"
+        json::PrintMode GetPrintMode() const;
+
     private:
+        class DataBaseHandler;
+
+        // every section of the input except base_requests and stat_requests
         json::Node json_data_base_;
+        std::optional<json::FlatDocument> stat_requests_;
+        catalogue::TransportCatalogue transport_catalogue_;
 
         domain::StopInputInfo ReadStopInputInfo(const json::Node &request);
 
@@ -7,12 +7,76 @@
 #include "json_builder.h"
 #include "transport_router.h"
 #include "serialization.h"
+#include "flat_base.h"
 
 using namespace std::literals;
 
 void PrintUsage(std::ostream &stream = std::cerr)
 {
-    stream << "Usage: transport_catalogue [make_base|process_requests]\n"sv;
+    stream << "Usage: transport_catalogue [make_base|update_base|process_requests]\n"sv;
+}
+
+// Everything process_requests and update_base take from a base
+struct LoadedBase
+{
+    const catalogue::TransportCatalogue &transport_catalogue;
+    const catalogue::renderer::MapRenderer &map_renderer;
+    const catalogue::tr_router::TransoprtRouter &transport_router;
+    const graph::CsrGraph<double> &graph;
+    const graph::RouterBase<double> &router;
+    bool is_flat;
+};
+
+// The base lives, and a flat base stays mapped, until the callback returns
+template <typename Callback>
+void LoadBase(const std::string &input_file, Callback callback)
+{
+    if (serialization::IsFlatBase(input_file))
+    {
+        const serialization::MappedFile base_file(input_file);
+        const serialization::FlatBase base(base_file.GetData());
+        catalogue::TransportCatalogue transport_catalogue = base.LoadCatalogue();
+        catalogue::renderer::MapRenderer map_renderer(base.LoadRenderSettings());
+        catalogue::tr_router::TransoprtRouter transport_router(transport_catalogue);
+        base.LoadTransportRouter(transport_router);
+        const graph::CsrGraph<double> graph = base.LoadGraph();
+        std::unique_ptr<graph::RouterBase<double>> router = base.LoadRouter(transport_router, graph);
+        callback(LoadedBase{transport_catalogue, map_renderer, transport_router, graph, *router, true});
+        return;
+    }
+    std::ifstream input(input_file, std::ios::binary);
+    proto_catalogue::TransportNavigator transport_navigator;
+    transport_navigator.ParseFromIstream(&input);
+    catalogue::TransportCatalogue transport_catalogue = serialization::DeserializeCatalogue(transport_navigator.catalogue());
+    catalogue::renderer::MapRenderer map_renderer(serialization::DeserializeMapRenderer(transport_navigator.render_settings()));
+    catalogue::tr_router::TransoprtRouter transport_router(transport_catalogue);
+    const graph::CsrGraph<double> graph(serialization::DeserializeTransportRouter(transport_navigator.transport_router(), transport_router));
+    std::unique_ptr<graph::RouterBase<double>> router = serialization::DeserializeRouter(transport_navigator.transport_router(), transport_router, graph);
+    callback(LoadedBase{transport_catalogue, map_renderer, transport_router, graph, *router, false});
+}
+
+// The base is written next to the file and takes its place at once, so a mapped base never changes under its readers
+void SaveBase(const std::string &output_file, bool is_flat, const catalogue::renderer::MapRenderer::RenderSettings &render_settings,
+              const catalogue::tr_router::TransoprtRouter &transport_router, const graph::CsrGraph<double> &graph,
+              const graph::RouterBase<double> &router)
+{
+    const std::string temporary_file = output_file + ".tmp"s;
+    {
+        std::ofstream output(temporary_file, std::ios::binary);
+        if (is_flat)
+        {
+            serialization::SaveFlatBase(output, render_settings, transport_router, graph, router);
+        }
+        else
+        {
+            serialization::SaveProtoBase(output, render_settings, transport_router, router);
+        }
+        if (!output.flush())
+        {
+            throw std::runtime_error("Cannot write "s + temporary_file);
+        }
+    }
+    std::filesystem::rename(temporary_file, output_file);
 }
 
 int main(int argc, char *argv[])
@@ -27,40 +91,59 @@ int main(int argc, char *argv[])
 
     if (mode == "make_base"sv)
     {
-        using Graph = graph::DirectedWeightedGraph<double>;
-        proto_catalogue::TransportNavigator transport_navigator;
         reader::JsonReader json_data_base(std::cin);
+        const json::Dict &serialization_settings = json_data_base.GetSerializationSettings().AsDict();
+        const std::string format = serialization_settings.count("format"s) ? serialization_settings.at("format"s).AsString() : "protobuf"s;
+        if (format != "protobuf"s && format != "flat"s)
+        {
+            throw std::invalid_argument("Unknown base format: "s + format);
+        }
         catalogue::TransportCatalogue transport_catalogue = json_data_base.CreateTransportCatalogue();
-        *transport_navigator.mutable_catalogue() = serialization::CreateProtoCatalogue(transport_catalogue);
+        // the base, the graph and the routing data built over it do not depend on the order of base_requests
+        transport_catalogue.OrderByName();
+        transport_catalogue.Finalize();
         catalogue::renderer::MapRenderer map_renderer(json_data_base.GetRenderSettings());
-        *transport_navigator.mutable_render_settings() = serialization::CreateProtoRenderSettings(map_renderer.GetRenderSettings());
         catalogue::tr_router::TransoprtRouter transport_router(transport_catalogue, json_data_base.GetRoutingSettings());
-        Graph graph = transport_router.CreateGraph();
-        *transport_navigator.mutable_transport_router() = serialization::CreateProtoTransportRouter(transport_router);
-        std::string output_file = json_data_base.GetSerializationSettings().AsDict().at("file"s).AsString();
-        std::ofstream output(output_file, std::ios::binary);
-        transport_navigator.SerializeToOstream(&output);
+        const graph::CsrGraph<double> graph(transport_router.CreateGraph());
+        // the routes table or the hierarchy is computed here once and stored in the base
+        const std::unique_ptr<graph::RouterBase<double>> router = transport_router.CreateRouter(graph);
+        SaveBase(serialization_settings.at("file"s).AsString(), format == "flat"s, map_renderer.GetRenderSettings(), transport_router, graph, *router);
+    }
+    else if (mode == "update_base"sv)
+    {
+        reader::JsonReader json_data_base(std::cin);
+        const std::string base_file = json_data_base.GetSerializationSettings().AsDict().at("file"s).AsString();
+        LoadBase(base_file, [&json_data_base, &base_file](const LoadedBase &base)
+                 {
+                     // the loaded base stays as it is, the parts the patch has not touched are taken from it
+                     catalogue::TransportCatalogue transport_catalogue = base.transport_catalogue;
+                     const domain::CatalogueChanges changes = json_data_base.ApplyPatchRequests(transport_catalogue);
+                     const catalogue::TransportCatalogue::Renumbering renumbering = transport_catalogue.OrderByName();
+                     transport_catalogue.Finalize();
+                     catalogue::tr_router::TransoprtRouter transport_router(transport_catalogue);
+                     transport_router.SetBusWaitTime(base.transport_router.GetBusWaitTime());
+                     transport_router.SetBusVelocity(base.transport_router.GetBusVelocity());
+                     transport_router.SetRouterType(base.transport_router.GetRouterType());
+                     transport_router.SetGraphModel(base.transport_router.GetGraphModel());
+                     graph::GraphUpdate update;
+                     const graph::CsrGraph<double> graph(transport_router.UpdateGraph(base.transport_router, base.graph, renumbering, changes, update));
+                     const std::unique_ptr<graph::RouterBase<double>> router = transport_router.UpdateRouter(graph, base.router, update);
+                     SaveBase(base_file, base.is_flat, base.map_renderer.GetRenderSettings(), transport_router, graph, *router);
+                 });
     }
     else if (mode == "process_requests"sv)
     {
         reader::JsonReader json_data_base(std::cin);
-        std::string input_file = json_data_base.GetSerializationSettings().AsDict().at("file"s).AsString();
-        std::ifstream input(input_file, std::ios::binary);
-        proto_catalogue::TransportNavigator transport_navigator;
-        transport_navigator.ParseFromIstream(&input);
-        catalogue::TransportCatalogue transport_catalogue = serialization::DeserializeCatalogue(transport_navigator.catalogue());
-        catalogue::renderer::MapRenderer map_renderer(serialization::DeserializeMapRenderer(transport_navigator.render_settings()));
-        catalogue::tr_router::TransoprtRouter transport_router(transport_catalogue);
-        using Graph = graph::DirectedWeightedGraph<double>;
-        Graph graph = serialization::DeserializeTransportRouter(transport_navigator.transport_router(), transport_router);
-        graph::Router router(graph);
-        handler::RequestHandler request_handler(transport_catalogue, map_renderer, transport_router, router);
-        json::Array information_found = request_handler.FindInformation(json_data_base.GetStatRequest());
-        json::Print(json::Document{json::Node{information_found}}, std::cout);
+        LoadBase(json_data_base.GetSerializationSettings().AsDict().at("file"s).AsString(), [&json_data_base](const LoadedBase &base)
+                 {
+                     handler::RequestHandler request_handler(base.transport_catalogue, base.map_renderer, base.transport_router, base.router);
+                     json::Writer writer(std::cout, json_data_base.GetPrintMode());
+                     request_handler.FindInformation(json_data_base.GetStatRequest(), writer);
+                 });
     }
     else
     {
         PrintUsage();
         return 1;
     }
-}
\ No newline at end of file
+}
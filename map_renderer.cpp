@@ -1,7 +1,5 @@
 #include "map_renderer.h"
 
-#include "transport_catalogue.h"
-
 namespace catalogue::renderer
 {
     using namespace std::string_literals;
@@ -42,22 +40,24 @@ namespace catalogue::renderer
         return render_settings_.padding;
     }
 
-    std::vector<svg::Polyline> MapRenderer::DrawRoutes(const renderer::SphereProjector &sphere_projector, const std::map<std::string_view, const domain::Bus *> &buses) const
+    std::vector<svg::Polyline> MapRenderer::DrawRoutes(const renderer::SphereProjector &sphere_projector, const TransportCatalogue &transport_catalogue,
+                                                       const std::vector<domain::BusId> &buses) const
     {
         std::vector<svg::Polyline> result;
         size_t color_num = 0;
-        for (const auto &bus : buses)
+        for (const domain::BusId bus_id : buses)
         {
+            const domain::Bus &bus = transport_catalogue.GetBus(bus_id);
             svg::Polyline line;
-            for (const auto &stop : bus.second->stops)
+            for (const domain::StopId stop : bus.stops)
             {
-                line.AddPoint(sphere_projector(*stop.second));
+                line.AddPoint(sphere_projector(transport_catalogue.GetStop(stop).coordinates));
             }
-            if (!bus.second->is_circular)
+            if (!bus.is_circular)
             {
-                for (size_t i = bus.second->stops.size() - 1; i > 0; --i)
+                for (size_t i = bus.stops.size() - 1; i > 0; --i)
                 {
-                    line.AddPoint(sphere_projector(*bus.second->stops[i - 1].second));
+                    line.AddPoint(sphere_projector(transport_catalogue.GetStop(bus.stops[i - 1]).coordinates));
                 }
             }
             line.SetFillColor("none"s);
@@ -79,21 +79,23 @@ namespace catalogue::renderer
         return result;
     }
 
-    std::vector<svg::Text> MapRenderer::DrawNameBuses(const renderer::SphereProjector &sphere_projector, const std::map<std::string_view, const domain::Bus *> &buses) const
+    std::vector<svg::Text> MapRenderer::DrawNameBuses(const renderer::SphereProjector &sphere_projector, const TransportCatalogue &transport_catalogue,
+                                                      const std::vector<domain::BusId> &buses) const
     {
         std::vector<svg::Text> result;
         size_t color_num = 0;
-        for (const auto &bus : buses)
+        for (const domain::BusId bus_id : buses)
         {
-            if (!bus.second->stops.empty())
+            const domain::Bus &bus = transport_catalogue.GetBus(bus_id);
+            if (!bus.stops.empty())
             {
                 svg::Text text;
-                text.SetPosition(sphere_projector(*bus.second->stops[0].second));
+                text.SetPosition(sphere_projector(transport_catalogue.GetStop(bus.stops[0]).coordinates));
                 text.SetOffset(svg::Point{render_settings_.bus_label_offset[0], render_settings_.bus_label_offset[1]});
                 text.SetFontSize(render_settings_.bus_label_font_size);
                 text.SetFontFamily("Verdana"s);
                 text.SetFontWeight("bold"s);
-                text.SetData(std::string{bus.first});
+                text.SetData(bus.name);
                 svg::Text text_underlayer = text;
                 text_underlayer.SetFillColor(render_settings_.underlayer_color);
                 text_underlayer.SetStrokeColor(render_settings_.underlayer_color);
@@ -111,12 +113,12 @@ namespace catalogue::renderer
                 }
                 result.emplace_back(text_underlayer);
                 result.emplace_back(text);
-                if (bus.second->stops[0] != bus.second->stops.back())
+                if (bus.stops[0] != bus.stops.back())
                 {
                     svg::Text text2 = text;
                     svg::Text text2_underlayer = text_underlayer;
-                    text2.SetPosition(sphere_projector(*bus.second->stops.back().second));
-                    text2_underlayer.SetPosition(sphere_projector(*bus.second->stops.back().second));
+                    text2.SetPosition(sphere_projector(transport_catalogue.GetStop(bus.stops.back()).coordinates));
+                    text2_underlayer.SetPosition(sphere_projector(transport_catalogue.GetStop(bus.stops.back()).coordinates));
                     result.emplace_back(text2_underlayer);
                     result.emplace_back(text2);
                 }
@@ -125,13 +127,14 @@ namespace catalogue::renderer
         return result;
     }
 
-    std::vector<svg::Circle> MapRenderer::DrawStopSymbols(const renderer::SphereProjector &sphere_projector, const std::map<std::string_view, const geo::Coordinates *> &stops) const
+    std::vector<svg::Circle> MapRenderer::DrawStopSymbols(const renderer::SphereProjector &sphere_projector, const TransportCatalogue &transport_catalogue,
+                                                          const std::vector<domain::StopId> &stops) const
     {
         std::vector<svg::Circle> result;
-        for (const auto &stop : stops)
+        for (const domain::StopId stop : stops)
         {
             svg::Circle circle;
-            circle.SetCenter(sphere_projector(*stop.second));
+            circle.SetCenter(sphere_projector(transport_catalogue.GetStop(stop).coordinates));
             circle.SetRadius(render_settings_.stop_radius);
             circle.SetFillColor("white"s);
             result.emplace_back(circle);
@@ -139,17 +142,19 @@ namespace catalogue::renderer
         return result;
     }
 
-    std::vector<svg::Text> MapRenderer::DrawNameStop(const renderer::SphereProjector &sphere_projector, const std::map<std::string_view, const geo::Coordinates *> &stops) const
+    std::vector<svg::Text> MapRenderer::DrawNameStop(const renderer::SphereProjector &sphere_projector, const TransportCatalogue &transport_catalogue,
+                                                     const std::vector<domain::StopId> &stops) const
     {
         std::vector<svg::Text> result;
-        for (const auto &stop : stops)
+        for (const domain::StopId stop_id : stops)
         {
+            const domain::Stop &stop = transport_catalogue.GetStop(stop_id);
             svg::Text text;
-            text.SetPosition(sphere_projector(*stop.second));
+            text.SetPosition(sphere_projector(stop.coordinates));
             text.SetOffset(svg::Point{render_settings_.stop_label_offset[0], render_settings_.stop_label_offset[1]});
             text.SetFontSize(render_settings_.stop_label_font_size);
             text.SetFontFamily("Verdana"s);
-            text.SetData(std::string{stop.first});
+            text.SetData(stop.name);
             svg::Text text_underlayer = text;
             text_underlayer.SetFillColor(render_settings_.underlayer_color);
             text_underlayer.SetStrokeColor(render_settings_.underlayer_color);
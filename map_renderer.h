@@ -5,7 +5,7 @@
 #include "svg.h"
 #include "json.h"
 #include "geo.h"
-#include "domain.h"
+#include "transport_catalogue.h"
 
 namespace catalogue::renderer
 {
@@ -57,13 +57,17 @@ namespace catalogue::renderer
 
         double GetPadding() const;
 
-        std::vector<svg::Polyline> DrawRoutes(const renderer::SphereProjector &sphere_projector, const std::map<std::string_view, const domain::Bus *> &buses) const;
+        std::vector<svg::Polyline> DrawRoutes(const renderer::SphereProjector &sphere_projector, const TransportCatalogue &transport_catalogue,
+                                              const std::vector<domain::BusId> &buses) const;
 
-        std::vector<svg::Text> DrawNameBuses(const renderer::SphereProjector &sphere_projector, const std::map<std::string_view, const domain::Bus *> &buses) const;
+        std::vector<svg::Text> DrawNameBuses(const renderer::SphereProjector &sphere_projector, const TransportCatalogue &transport_catalogue,
+                                             const std::vector<domain::BusId> &buses) const;
 
-        std::vector<svg::Circle> DrawStopSymbols(const renderer::SphereProjector &sphere_projector, const std::map<std::string_view, const geo::Coordinates *> &stops) const;
+        std::vector<svg::Circle> DrawStopSymbols(const renderer::SphereProjector &sphere_projector, const TransportCatalogue &transport_catalogue,
+                                                 const std::vector<domain::StopId> &stops) const;
 
-        std::vector<svg::Text> DrawNameStop(const renderer::SphereProjector &sphere_projector, const std::map<std::string_view, const geo::Coordinates *> &stops) const;
+        std::vector<svg::Text> DrawNameStop(const renderer::SphereProjector &sphere_projector, const TransportCatalogue &transport_catalogue,
+                                            const std::vector<domain::StopId> &stops) const;
 
         const RenderSettings &GetRenderSettings() const;
 
@@ -0,0 +1,74 @@
+#include <charconv>
+#include <iterator>
+
+#include "output_buffer.h"
+
+namespace output
+{
+    Buffer::Buffer(std::ostream &output)
+        : output_(output)
+    {
+        buffer_.reserve(FLUSH_SIZE + FLUSH_SIZE / 2);
+    }
+
+    Buffer::~Buffer()
+    {
+        Flush();
+    }
+
+    Buffer &Buffer::operator<<(std::string_view text)
+    {
+        buffer_.append(text);
+        FlushIfFull();
+        return *this;
+    }
+
+    Buffer &Buffer::operator<<(char c)
+    {
+        buffer_.push_back(c);
+        FlushIfFull();
+        return *this;
+    }
+
+    Buffer &Buffer::operator<<(int value)
+    {
+        char text[16];
+        const auto [end, error] = std::to_chars(std::begin(text), std::end(text), value);
+        return *this << std::string_view(text, static_cast<size_t>(end - text));
+    }
+
+    Buffer &Buffer::operator<<(unsigned value)
+    {
+        char text[16];
+        const auto [end, error] = std::to_chars(std::begin(text), std::end(text), value);
+        return *this << std::string_view(text, static_cast<size_t>(end - text));
+    }
+
+    Buffer &Buffer::operator<<(double value)
+    {
+        // the general format with precision 6 is defined as printf("%.6g"), which std::ostream uses as well
+        char text[32];
+        const auto [end, error] = std::to_chars(std::begin(text), std::end(text), value, std::chars_format::general, 6);
+        return *this << std::string_view(text, static_cast<size_t>(end - text));
+    }
+
+    void Buffer::Fill(char c, size_t count)
+    {
+        buffer_.append(count, c);
+        FlushIfFull();
+    }
+
+    void Buffer::Flush()
+    {
+        output_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        buffer_.clear();
+    }
+
+    void Buffer::FlushIfFull()
+    {
+        if (buffer_.size() >= FLUSH_SIZE)
+        {
+            Flush();
+        }
+    }
+}
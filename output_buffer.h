@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace output
+{
+    // Collects text for a stream and passes it on in large pieces. Numbers are formatted with std::to_chars
+    // into the same text as std::ostream with the default flags gives, without its locale machinery
+    class Buffer
+    {
+    public:
+        explicit Buffer(std::ostream &output);
+
+        Buffer(const Buffer &) = delete;
+
+        Buffer &operator=(const Buffer &) = delete;
+
+        ~Buffer();
+
+        Buffer &operator<<(std::string_view text);
+
+        Buffer &operator<<(char c);
+
+        Buffer &operator<<(int value);
+
+        Buffer &operator<<(unsigned value);
+
+        // Six significant digits, as "%g"
+        Buffer &operator<<(double value);
+
+        void Fill(char c, size_t count);
+
+        // Passes the collected text to the stream
+        void Flush();
+
+    private:
+        static constexpr size_t FLUSH_SIZE = 1 << 16;
+
+        std::ostream &output_;
+        std::string buffer_;
+
+        void FlushIfFull();
+    };
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include "graph.h"
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GRAPH_RELAX_ROW_X86
+#include <immintrin.h>
+#endif
+
+namespace graph
+{
+
+    // Relaxes a row of the routes table through a vertex: the route from -> to is replaced by
+    // from -> through -> to when it is lighter. Rows use the sentinels of Router: no_route in prev_edges marks
+    // a missing route, no_prev_edge - a route without edges, the weight of a missing route is the largest one.
+    template <typename Weight>
+    struct RelaxRowArguments
+    {
+        Weight *weights;
+        uint32_t *prev_edges;
+        const Weight *weights_through;
+        const uint32_t *prev_edges_through;
+        size_t count;
+        Weight weight_from;
+        uint32_t prev_edge_from;
+        uint32_t no_route;
+        uint32_t no_prev_edge;
+    };
+
+    template <typename Weight>
+    using RelaxRowFunction = void (*)(const RelaxRowArguments<Weight> &arguments);
+
+    template <typename Weight>
+    void RelaxRowTail(const RelaxRowArguments<Weight> &arguments, size_t first)
+    {
+        for (size_t to = first; to < arguments.count; ++to)
+        {
+            const uint32_t prev_edge_through = arguments.prev_edges_through[to];
+            if (prev_edge_through == arguments.no_route)
+            {
+                continue;
+            }
+            const Weight candidate_weight = arguments.weight_from + arguments.weights_through[to];
+            if (arguments.prev_edges[to] == arguments.no_route || candidate_weight < arguments.weights[to])
+            {
+                arguments.weights[to] = candidate_weight;
+                arguments.prev_edges[to] = prev_edge_through != arguments.no_prev_edge ? prev_edge_through : arguments.prev_edge_from;
+            }
+        }
+    }
+
+    template <typename Weight>
+    void RelaxRowScalar(const RelaxRowArguments<Weight> &arguments)
+    {
+        RelaxRowTail(arguments, 0);
+    }
+
+#ifdef GRAPH_RELAX_ROW_X86
+    // A missing route weighs infinity, so a single "candidate < current" comparison gives the same decisions
+    // as the scalar loop: a missing route through the vertex is never lighter, a missing current route always is.
+
+    __attribute__((target("sse4.1"))) inline void RelaxRowSse4(const RelaxRowArguments<double> &arguments)
+    {
+        const __m128d weight_from = _mm_set1_pd(arguments.weight_from);
+        const __m128i prev_edge_from = _mm_set1_epi32(static_cast<int>(arguments.prev_edge_from));
+        const __m128i no_prev_edge = _mm_set1_epi32(static_cast<int>(arguments.no_prev_edge));
+        size_t to = 0;
+        for (; to + 2 <= arguments.count; to += 2)
+        {
+            const __m128d candidate = _mm_add_pd(weight_from, _mm_loadu_pd(arguments.weights_through + to));
+            const __m128d current = _mm_loadu_pd(arguments.weights + to);
+            const __m128d less = _mm_cmplt_pd(candidate, current);
+            if (_mm_movemask_pd(less) == 0)
+            {
+                continue;
+            }
+            _mm_storeu_pd(arguments.weights + to, _mm_blendv_pd(current, candidate, less));
+            const __m128i through = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(arguments.prev_edges_through + to));
+            const __m128i prev = _mm_blendv_epi8(through, prev_edge_from, _mm_cmpeq_epi32(through, no_prev_edge));
+            const __m128i less_epi32 = _mm_castps_si128(_mm_shuffle_ps(_mm_castpd_ps(less), _mm_castpd_ps(less), _MM_SHUFFLE(2, 0, 2, 0)));
+            const __m128i old = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(arguments.prev_edges + to));
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(arguments.prev_edges + to), _mm_blendv_epi8(old, prev, less_epi32));
+        }
+        RelaxRowTail(arguments, to);
+    }
+
+    __attribute__((target("avx2"))) inline void RelaxRowAvx2(const RelaxRowArguments<double> &arguments)
+    {
+        const __m256d weight_from = _mm256_set1_pd(arguments.weight_from);
+        const __m128i prev_edge_from = _mm_set1_epi32(static_cast<int>(arguments.prev_edge_from));
+        const __m128i no_prev_edge = _mm_set1_epi32(static_cast<int>(arguments.no_prev_edge));
+        const __m256i even_lanes = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+        size_t to = 0;
+        for (; to + 4 <= arguments.count; to += 4)
+        {
+            const __m256d candidate = _mm256_add_pd(weight_from, _mm256_loadu_pd(arguments.weights_through + to));
+            const __m256d current = _mm256_loadu_pd(arguments.weights + to);
+            const __m256d less = _mm256_cmp_pd(candidate, current, _CMP_LT_OQ);
+            if (_mm256_movemask_pd(less) == 0)
+            {
+                continue;
+            }
+            _mm256_storeu_pd(arguments.weights + to, _mm256_blendv_pd(current, candidate, less));
+            const __m128i through = _mm_loadu_si128(reinterpret_cast<const __m128i *>(arguments.prev_edges_through + to));
+            const __m128i prev = _mm_blendv_epi8(through, prev_edge_from, _mm_cmpeq_epi32(through, no_prev_edge));
+            const __m128i less_epi32 = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_castpd_si256(less), even_lanes));
+            const __m128i old = _mm_loadu_si128(reinterpret_cast<const __m128i *>(arguments.prev_edges + to));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(arguments.prev_edges + to), _mm_blendv_epi8(old, prev, less_epi32));
+        }
+        RelaxRowTail(arguments, to);
+    }
+
+    __attribute__((target("sse4.1"))) inline void RelaxRowSse4(const RelaxRowArguments<float> &arguments)
+    {
+        const __m128 weight_from = _mm_set1_ps(arguments.weight_from);
+        const __m128i prev_edge_from = _mm_set1_epi32(static_cast<int>(arguments.prev_edge_from));
+        const __m128i no_prev_edge = _mm_set1_epi32(static_cast<int>(arguments.no_prev_edge));
+        size_t to = 0;
+        for (; to + 4 <= arguments.count; to += 4)
+        {
+            const __m128 candidate = _mm_add_ps(weight_from, _mm_loadu_ps(arguments.weights_through + to));
+            const __m128 current = _mm_loadu_ps(arguments.weights + to);
+            const __m128 less = _mm_cmplt_ps(candidate, current);
+            if (_mm_movemask_ps(less) == 0)
+            {
+                continue;
+            }
+            _mm_storeu_ps(arguments.weights + to, _mm_blendv_ps(current, candidate, less));
+            const __m128i through = _mm_loadu_si128(reinterpret_cast<const __m128i *>(arguments.prev_edges_through + to));
+            const __m128i prev = _mm_blendv_epi8(through, prev_edge_from, _mm_cmpeq_epi32(through, no_prev_edge));
+            const __m128i old = _mm_loadu_si128(reinterpret_cast<const __m128i *>(arguments.prev_edges + to));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(arguments.prev_edges + to), _mm_blendv_epi8(old, prev, _mm_castps_si128(less)));
+        }
+        RelaxRowTail(arguments, to);
+    }
+
+    __attribute__((target("avx2"))) inline void RelaxRowAvx2(const RelaxRowArguments<float> &arguments)
+    {
+        const __m256 weight_from = _mm256_set1_ps(arguments.weight_from);
+        const __m256i prev_edge_from = _mm256_set1_epi32(static_cast<int>(arguments.prev_edge_from));
+        const __m256i no_prev_edge = _mm256_set1_epi32(static_cast<int>(arguments.no_prev_edge));
+        size_t to = 0;
+        for (; to + 8 <= arguments.count; to += 8)
+        {
+            const __m256 candidate = _mm256_add_ps(weight_from, _mm256_loadu_ps(arguments.weights_through + to));
+            const __m256 current = _mm256_loadu_ps(arguments.weights + to);
+            const __m256 less = _mm256_cmp_ps(candidate, current, _CMP_LT_OQ);
+            if (_mm256_movemask_ps(less) == 0)
+            {
+                continue;
+            }
+            _mm256_storeu_ps(arguments.weights + to, _mm256_blendv_ps(current, candidate, less));
+            const __m256i through = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(arguments.prev_edges_through + to));
+            const __m256i prev = _mm256_blendv_epi8(through, prev_edge_from, _mm256_cmpeq_epi32(through, no_prev_edge));
+            const __m256i old = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(arguments.prev_edges + to));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(arguments.prev_edges + to), _mm256_blendv_epi8(old, prev, _mm256_castps_si256(less)));
+        }
+        RelaxRowTail(arguments, to);
+    }
+#endif
+
+    enum class RelaxRowKernel
+    {
+        SCALAR,
+        SSE4,
+        AVX2,
+    };
+
+    // The widest kernel supported by the processor; the vector kernels exist only for float and double
+    template <typename Weight>
+    RelaxRowKernel GetBestRelaxRowKernel()
+    {
+#ifdef GRAPH_RELAX_ROW_X86
+        if constexpr (std::is_same_v<Weight, double> || std::is_same_v<Weight, float>)
+        {
+            static_assert(std::numeric_limits<Weight>::has_infinity);
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))
+            {
+                return RelaxRowKernel::AVX2;
+            }
+            if (__builtin_cpu_supports("sse4.1"))
+            {
+                return RelaxRowKernel::SSE4;
+            }
+        }
+#endif
+        return RelaxRowKernel::SCALAR;
+    }
+
+    // Falls back to the scalar loop when the kernel is not available for Weight
+    template <typename Weight>
+    RelaxRowFunction<Weight> GetRelaxRowFunction(RelaxRowKernel kernel)
+    {
+#ifdef GRAPH_RELAX_ROW_X86
+        if constexpr (std::is_same_v<Weight, double> || std::is_same_v<Weight, float>)
+        {
+            if (kernel == RelaxRowKernel::AVX2)
+            {
+                return static_cast<RelaxRowFunction<Weight>>(RelaxRowAvx2);
+            }
+            if (kernel == RelaxRowKernel::SSE4)
+            {
+                return static_cast<RelaxRowFunction<Weight>>(RelaxRowSse4);
+            }
+        }
+#endif
+        return RelaxRowScalar<Weight>;
+    }
+
+} // namespace graph
@@ -6,29 +6,33 @@
 
 namespace handler
 {
-    using namespace std::string_literals;
+    using namespace std::literals;
 
     RequestHandler::RequestHandler(const catalogue::TransportCatalogue &transport_catalogue, const catalogue::renderer::MapRenderer &renderer,
-                                   const catalogue::tr_router::TransoprtRouter &transport_router, const graph::Router<double> &router)
+                                   const catalogue::tr_router::TransoprtRouter &transport_router, const graph::RouterBase<double> &router)
         : transport_catalogue_(transport_catalogue), renderer_(renderer), transport_router_(transport_router), router_(router)
     {
     }
 
-    json::Node RequestHandler::CollectStopInformation(const domain::StopInformation &stop, int request_id)
+    void RequestHandler::WriteStopInformation(const domain::StopInformation &stop, int request_id, json::Writer &writer)
     {
         if (!stop.name_stop.empty())
         {
-            json::Array buses;
-            buses.reserve(stop.buses.size());
-            for (const auto bus : stop.buses)
+            writer.StartDict();
+            writer.Key("buses"sv);
+            writer.StartArray();
+            for (const domain::BusId bus : stop.buses)
             {
-                buses.emplace_back(std::string{bus});
+                writer.String(transport_catalogue_.GetBus(bus).name);
             }
-            return json::Builder{}.StartDict().Key("buses"s).Value(buses).Key("request_id"s).Value(request_id).EndDict().Build();
+            writer.EndArray();
+            writer.Key("request_id"sv);
+            writer.Value(request_id);
+            writer.EndDict();
         }
         else
         {
-            return json::Builder{}.StartDict().Key("request_id"s).Value(request_id).Key("error_message"s).Value("not found"s).EndDict().Build();
+            writer.Value(json::Builder{}.StartDict().Key("request_id"s).Value(request_id).Key("error_message"s).Value("not found"s).EndDict().Build());
         }
     }
 
@@ -71,51 +75,108 @@ namespace handler
     svg::Document RequestHandler::RenderMap() const
     {
         svg::Document result;
-        std::map<std::string_view, const geo::Coordinates *> stops = transport_catalogue_.FindAllWorkingStops();
-        std::map<std::string_view, const domain::Bus *> buses = transport_catalogue_.FindAllWorkingBuses();
+        std::vector<domain::StopId> stops = transport_catalogue_.FindAllWorkingStops();
+        std::vector<domain::BusId> buses = transport_catalogue_.FindAllWorkingBuses();
 
         std::vector<geo::Coordinates> coordinates;
-        for (const auto &stop : stops)
+        coordinates.reserve(stops.size());
+        for (const domain::StopId stop : stops)
         {
-            coordinates.emplace_back(*stop.second);
+            coordinates.emplace_back(transport_catalogue_.GetStop(stop).coordinates);
         }
 
         catalogue::renderer::SphereProjector sphere_projector(coordinates.begin(), coordinates.end(), renderer_.GetWidth(), renderer_.GetHeight(), renderer_.GetPadding());
-        for (auto rout : renderer_.DrawRoutes(sphere_projector, buses))
+        for (auto rout : renderer_.DrawRoutes(sphere_projector, transport_catalogue_, buses))
         {
             result.Add(rout);
         }
-        for (auto name_bus : renderer_.DrawNameBuses(sphere_projector, buses))
+        for (auto name_bus : renderer_.DrawNameBuses(sphere_projector, transport_catalogue_, buses))
         {
             result.Add(name_bus);
         }
-        for (auto stop_symbol : renderer_.DrawStopSymbols(sphere_projector, stops))
+        for (auto stop_symbol : renderer_.DrawStopSymbols(sphere_projector, transport_catalogue_, stops))
         {
             result.Add(stop_symbol);
         }
-        for (auto name_stop : renderer_.DrawNameStop(sphere_projector, stops))
+        for (auto name_stop : renderer_.DrawNameStop(sphere_projector, transport_catalogue_, stops))
         {
             result.Add(name_stop);
         }
         return result;
     }
 
-    json::Array RequestHandler::FindInformation(const json::Node &json_data_base)
+    std::unordered_map<graph::VertexId, RequestHandler::RouteGroup> RequestHandler::GroupRoutes(const json::FlatArray &stat_requests) const
     {
-        auto stat_requests = json_data_base.AsArray();
-        json::Array information_found;
-        information_found.reserve(stat_requests.size());
-        for (const auto &request : stat_requests)
+        std::unordered_map<graph::VertexId, RouteGroup> route_groups;
+        if (!router_.SharesSearches())
+        {
+            return route_groups;
+        }
+        for (size_t i = 0; i < stat_requests.size(); ++i)
         {
+            const json::FlatDict request = stat_requests[i].AsDict();
+            if (request.at("type"s).AsString() != "Route"s)
+            {
+                continue;
+            }
+            const std::string_view from = request.at("from"s).AsString();
+            const std::string_view to = request.at("to"s).AsString();
+            if (from != to && transport_router_.StopIsWorking(from) && transport_router_.StopIsWorking(to))
+            {
+                route_groups[transport_router_.GetStopId(from)].targets.push_back(transport_router_.GetStopId(to));
+            }
+        }
+        return route_groups;
+    }
+
+    domain::RouteInformation RequestHandler::FindRoute(const json::FlatDict &request, std::unordered_map<graph::VertexId, RouteGroup> &route_groups) const
+    {
+        const std::string_view from = request.at("from"s).AsString();
+        const std::string_view to = request.at("to"s).AsString();
+        if (from == to)
+        {
+            return transport_router_.FindRouteInformation(graph::RouterBase<double>::RouteInfo{0, {}});
+        }
+        if (!transport_router_.StopIsWorking(from) || !transport_router_.StopIsWorking(to))
+        {
+            return transport_router_.FindRouteInformation(std::nullopt);
+        }
+        const graph::VertexId origin = transport_router_.GetStopId(from);
+        if (!router_.SharesSearches())
+        {
+            return transport_router_.FindRouteInformation(router_.BuildRoute(origin, transport_router_.GetStopId(to)));
+        }
+        const auto group = route_groups.find(origin);
+        RouteGroup &route_group = group->second;
+        if (route_group.answered == 0)
+        {
+            route_group.routes = router_.BuildRoutes(origin, route_group.targets);
+        }
+        domain::RouteInformation route = transport_router_.FindRouteInformation(route_group.routes[route_group.answered++]);
+        if (route_group.answered == route_group.targets.size())
+        {
+            route_groups.erase(group);
+        }
+        return route;
+    }
+
+    void RequestHandler::FindInformation(const json::FlatNode &json_data_base, json::Writer &writer)
+    {
+        const json::FlatArray stat_requests = json_data_base.AsArray();
+        std::unordered_map<graph::VertexId, RouteGroup> route_groups = GroupRoutes(stat_requests);
+        writer.StartArray();
+        for (size_t i = 0; i < stat_requests.size(); ++i)
+        {
+            const json::FlatNode &request = stat_requests[i];
             if (request.AsDict().at("type"s).AsString() == "Stop"s)
             {
                 auto stop = transport_catalogue_.FindStopInformation(request.AsDict().at("name"s).AsString());
-                information_found.emplace_back(CollectStopInformation(stop, request.AsDict().at("id"s).AsInt()));
+                WriteStopInformation(stop, request.AsDict().at("id"s).AsInt(), writer);
             }
             else if (request.AsDict().at("type"s).AsString() == "Bus"s)
             {
                 auto bus = transport_catalogue_.FindBusInformation(request.AsDict().at("name"s).AsString());
-                information_found.emplace_back(CollectBusInformation(bus, request.AsDict().at("id"s).AsInt()));
+                writer.Value(CollectBusInformation(bus, request.AsDict().at("id"s).AsInt()));
             }
             else if (request.AsDict().at("type"s).AsString() == "Map"s)
             {
@@ -123,22 +184,13 @@ namespace handler
                 svg::Document map = RenderMap();
                 std::ostringstream strm;
                 map.Render(strm);
-                information_found.emplace_back(json::Builder{}.StartDict().Key("map"s).Value(strm.str()).Key("request_id"s).Value(request.AsDict().at("id"s).AsInt()).EndDict().Build());
+                writer.Value(json::Builder{}.StartDict().Key("map"s).Value(strm.str()).Key("request_id"s).Value(request.AsDict().at("id"s).AsInt()).EndDict().Build());
             }
             else if (request.AsDict().at("type"s).AsString() == "Route"s)
             {
-                std::optional<graph::Router<double>::RouteInfo> route;
-                if (request.AsDict().at("from"s).AsString() == request.AsDict().at("to"s).AsString())
-                {
-                    route = {0, {}};
-                }
-                else if (transport_router_.StopIsWorking(request.AsDict().at("from"s).AsString()) && transport_router_.StopIsWorking(request.AsDict().at("to"s).AsString()))
-                {
-                    route = router_.BuildRoute(transport_router_.GetStopId(request.AsDict().at("from"s).AsString()), transport_router_.GetStopId(request.AsDict().at("to"s).AsString()));
-                }
-                information_found.emplace_back(CollectRouteInformation(transport_router_.FindRouteInformation(route), request.AsDict().at("id"s).AsInt()));
+                writer.Value(CollectRouteInformation(FindRoute(request.AsDict(), route_groups), request.AsDict().at("id"s).AsInt()));
             }
         }
-        return information_found;
+        writer.EndArray();
     }
 }
\ No newline at end of file
@@ -2,6 +2,9 @@
 
 #include "transport_router.h"
 #include "map_renderer.h"
+#include "json_flat.h"
+
+#include <unordered_map>
 
 namespace handler
 {
@@ -9,22 +12,38 @@ namespace handler
     {
     public:
         RequestHandler(const catalogue::TransportCatalogue &transport_catalogue, const catalogue::renderer::MapRenderer &renderer,
-                       const catalogue::tr_router::TransoprtRouter &transport_router, const graph::Router<double> &router);
+                       const catalogue::tr_router::TransoprtRouter &transport_router, const graph::RouterBase<double> &router);
 
         svg::Document RenderMap() const;
 
-        json::Array FindInformation(const json::Node &stat_requests);
+        // Every answer is written as soon as it is found
+        void FindInformation(const json::FlatNode &stat_requests, json::Writer &writer);
 
     private:
         const catalogue::TransportCatalogue &transport_catalogue_;
         const catalogue::renderer::MapRenderer &renderer_;
         const catalogue::tr_router::TransoprtRouter &transport_router_;
-        const graph::Router<double> &router_;
+        const graph::RouterBase<double> &router_;
 
-        json::Node CollectStopInformation(const domain::StopInformation &stop, int request_id);
+        // Bus names go to the writer straight from the catalogue
+        void WriteStopInformation(const domain::StopInformation &stop, int request_id, json::Writer &writer);
 
         json::Node CollectBusInformation(const domain::BusInformation &bus, int request_id);
 
         json::Node CollectRouteInformation(const domain::RouteInformation &route, int request_id);
+
+        // Route requests of one origin for a router sharing its searches. The routes are found when the first request
+        // of the group is answered and freed after the last one
+        struct RouteGroup
+        {
+            std::vector<graph::VertexId> targets;
+            std::vector<std::optional<graph::RouterBase<double>::RouteInfo>> routes;
+            size_t answered = 0;
+        };
+
+        // Empty unless the router shares its searches
+        std::unordered_map<graph::VertexId, RouteGroup> GroupRoutes(const json::FlatArray &stat_requests) const;
+
+        domain::RouteInformation FindRoute(const json::FlatDict &request, std::unordered_map<graph::VertexId, RouteGroup> &route_groups) const;
     };
 }
\ No newline at end of file
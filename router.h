@@ -1,13 +1,21 @@
 #pragma once
 
-#include "graph.h"
+#include "csr_graph.h"
+#include "relax_row.h"
 
 #include <algorithm>
 #include <cassert>
+#include <condition_variable>
 #include <cstdint>
+#include <functional>
 #include <iterator>
+#include <limits>
+#include <mutex>
+#include <numeric>
 #include <optional>
+#include <queue>
 #include <stdexcept>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -16,117 +24,580 @@ namespace graph
 {
 
     template <typename Weight>
-    class Router
+    class RouterBase
     {
-    private:
-        using Graph = DirectedWeightedGraph<Weight>;
-
     public:
-        explicit Router() = default;
-        explicit Router(const Graph &graph);
-
         struct RouteInfo
         {
             Weight weight;
             std::vector<EdgeId> edges;
         };
 
-        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+        virtual std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const = 0;
+
+        // Routes from one vertex to several others; routers sharing one search between the targets override it
+        virtual std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId> &to) const
+        {
+            std::vector<std::optional<RouteInfo>> routes;
+            routes.reserve(to.size());
+            for (const VertexId vertex : to)
+            {
+                routes.push_back(BuildRoute(from, vertex));
+            }
+            return routes;
+        }
+
+        // Whether BuildRoutes finds the routes of several targets faster than BuildRoute does one by one
+        virtual bool SharesSearches() const
+        {
+            return false;
+        }
+
+        virtual ~RouterBase() = default;
+    };
+
+    // tile_size 0 - the table is relaxed row by row through every vertex in turn, otherwise it is split into
+    // tile_size x tile_size tiles relaxed in the three phases of the blocked Floyd-Warshall algorithm.
+    // kernel is the widest supported one when not set
+    struct RoutesTableSettings
+    {
+        size_t thread_count = 1;
+        size_t tile_size = 0;
+        std::optional<RelaxRowKernel> kernel;
+    };
+
+    template <typename Weight, typename Graph = CsrGraph<Weight>>
+    class Router final : public RouterBase<Weight>
+    {
+    public:
+        using typename RouterBase<Weight>::RouteInfo;
+
+        using PrevEdge = uint32_t;
+        static constexpr PrevEdge NO_ROUTE = std::numeric_limits<PrevEdge>::max();
+        static constexpr PrevEdge NO_PREV_EDGE = NO_ROUTE - 1;
+        static constexpr Weight UNREACHABLE_WEIGHT = std::numeric_limits<Weight>::has_infinity ? std::numeric_limits<Weight>::infinity()
+                                                                                                : std::numeric_limits<Weight>::max();
+
+        // Row-major vertex_count x vertex_count table. A missing route has NO_ROUTE prev edge and UNREACHABLE_WEIGHT,
+        // a route without edges has NO_PREV_EDGE
+        struct RoutesInternalData
+        {
+            size_t vertex_count = 0;
+            std::vector<Weight> weights;
+            std::vector<PrevEdge> prev_edges;
+        };
+
+        // The same table laid out elsewhere, e.g. in a mapped base file
+        struct RoutesTableView
+        {
+            size_t vertex_count = 0;
+            const Weight *weights = nullptr;
+            const PrevEdge *prev_edges = nullptr;
+        };
+
+        explicit Router() = default;
+        // The table does not depend on the number of threads and on the kernel
+        explicit Router(const Graph &graph, const RoutesTableSettings &settings = {});
+        Router(const Graph &graph, RoutesInternalData routes_internal_data);
+        // The table is not copied and has to outlive the router
+        Router(const Graph &graph, const RoutesTableView &routes_table);
+        // The table of the graph before the update: the routes which do not go over a removed edge are kept, the broken
+        // ones are searched again from them without the added edges, then the added edges are inserted one by one. An edge
+        // changes only the rows it makes a route lighter in, so the work follows the size of the update rather than of the graph
+        Router(const Graph &graph, const RoutesTableView &previous_table, const GraphUpdate &update);
+
+        Router(const Router &) = delete;
+        Router &operator=(const Router &) = delete;
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+        // Empty for a router over a table of someone else
+        const RoutesInternalData &GetRoutesInternalData() const;
+
+        const RoutesTableView &GetRoutesTable() const;
 
     private:
-        struct RouteInternalData
+        enum class RouteState : uint8_t
         {
-            Weight weight;
-            std::optional<EdgeId> prev_edge;
+            UNKNOWN,
+            KEPT,
+            BROKEN
+        };
+
+        // Threads wait for each other before the next vertex or the next phase of the relaxation
+        class Barrier
+        {
+        public:
+            explicit Barrier(size_t thread_count)
+                : thread_count_(thread_count)
+            {
+            }
+
+            void ArriveAndWait()
+            {
+                std::unique_lock lock(mutex_);
+                const size_t generation = generation_;
+                if (++arrived_ == thread_count_)
+                {
+                    arrived_ = 0;
+                    ++generation_;
+                    condition_.notify_all();
+                    return;
+                }
+                condition_.wait(lock, [this, generation]
+                                { return generation_ != generation; });
+            }
+
+        private:
+            std::mutex mutex_;
+            std::condition_variable condition_;
+            const size_t thread_count_;
+            size_t arrived_ = 0;
+            size_t generation_ = 0;
         };
-        using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
 
         void InitializeRoutesInternalData(const Graph &graph)
         {
             const size_t vertex_count = graph.GetVertexCount();
+            if (graph.GetEdgeCount() >= NO_PREV_EDGE)
+            {
+                throw std::length_error("Too many edges for the routes table");
+            }
+            routes_internal_data_.vertex_count = vertex_count;
+            routes_internal_data_.weights.assign(vertex_count * vertex_count, UNREACHABLE_WEIGHT);
+            routes_internal_data_.prev_edges.assign(vertex_count * vertex_count, NO_ROUTE);
+            for (VertexId vertex = 0; vertex < vertex_count; ++vertex)
+            {
+                Weight *weights = &routes_internal_data_.weights[vertex * vertex_count];
+                PrevEdge *prev_edges = &routes_internal_data_.prev_edges[vertex * vertex_count];
+                weights[vertex] = ZERO_WEIGHT;
+                prev_edges[vertex] = NO_PREV_EDGE;
+                graph.ForEachIncidentEdge(vertex, [weights, prev_edges](EdgeId edge_id, VertexId to, Weight weight)
+                                          {
+                                              if (weight < ZERO_WEIGHT)
+                                              {
+                                                  throw std::domain_error("Edges' weights should be non-negative");
+                                              }
+                                              if (prev_edges[to] == NO_ROUTE || weights[to] > weight)
+                                              {
+                                                  weights[to] = weight;
+                                                  prev_edges[to] = static_cast<PrevEdge>(edge_id);
+                                              }
+                                          });
+            }
+        }
+
+        // Relaxes the routes [first_from, last_from) x [first_to, last_to) through the vertices [first_through, last_through)
+        // taken in turn. Row vertex_through is never changed by its own relaxation, so the rows are independent
+        void RelaxRoutesInternalData(VertexId first_from, VertexId last_from, VertexId first_to, VertexId last_to,
+                                     VertexId first_through, VertexId last_through)
+        {
+            const size_t vertex_count = routes_internal_data_.vertex_count;
+            RelaxRowArguments<Weight> arguments{};
+            arguments.count = last_to - first_to;
+            arguments.no_route = NO_ROUTE;
+            arguments.no_prev_edge = NO_PREV_EDGE;
+            for (VertexId vertex_through = first_through; vertex_through < last_through; ++vertex_through)
+            {
+                arguments.weights_through = &routes_internal_data_.weights[vertex_through * vertex_count + first_to];
+                arguments.prev_edges_through = &routes_internal_data_.prev_edges[vertex_through * vertex_count + first_to];
+                for (VertexId vertex_from = first_from; vertex_from < last_from; ++vertex_from)
+                {
+                    const size_t route_through = vertex_from * vertex_count + vertex_through;
+                    if (routes_internal_data_.prev_edges[route_through] == NO_ROUTE)
+                    {
+                        continue;
+                    }
+                    arguments.weights = &routes_internal_data_.weights[vertex_from * vertex_count + first_to];
+                    arguments.prev_edges = &routes_internal_data_.prev_edges[vertex_from * vertex_count + first_to];
+                    arguments.weight_from = routes_internal_data_.weights[route_through];
+                    arguments.prev_edge_from = routes_internal_data_.prev_edges[route_through];
+                    relax_row_(arguments);
+                }
+            }
+        }
+
+        // The routes of the row which went through a removed edge are searched again over the kept edges. The other routes
+        // are still the shortest ones, so the search starts from them and goes over the broken part of the row only
+        void RepairRow(const Graph &graph, VertexId vertex_from, const std::vector<bool> &is_kept_edge,
+                       const std::vector<size_t> &incoming_offsets, const std::vector<EdgeId> &incoming_edges,
+                       std::vector<RouteState> &states)
+        {
+            const size_t vertex_count = routes_internal_data_.vertex_count;
+            Weight *weights = &routes_internal_data_.weights[vertex_from * vertex_count];
+            PrevEdge *prev_edges = &routes_internal_data_.prev_edges[vertex_from * vertex_count];
+            std::vector<VertexId> chain;
             for (VertexId vertex = 0; vertex < vertex_count; ++vertex)
             {
-                routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
-                for (const EdgeId edge_id : graph.GetIncidentEdges(vertex))
+                for (VertexId link = vertex; states[link] == RouteState::UNKNOWN; link = graph.GetEdge(prev_edges[link]).from)
                 {
-                    const auto &edge = graph.GetEdge(edge_id);
-                    if (edge.weight < ZERO_WEIGHT)
+                    if (prev_edges[link] == NO_ROUTE || prev_edges[link] == NO_PREV_EDGE)
                     {
-                        throw std::domain_error("Edges' weights should be non-negative");
+                        states[link] = RouteState::KEPT;
+                        break;
                     }
-                    auto &route_internal_data = routes_internal_data_[vertex][edge.to];
-                    if (!route_internal_data || route_internal_data->weight > edge.weight)
+                    chain.push_back(link);
+                }
+                const RouteState state = states[chain.empty() ? vertex : graph.GetEdge(prev_edges[chain.back()]).from];
+                for (const VertexId link : chain)
+                {
+                    states[link] = state;
+                }
+                chain.clear();
+            }
+
+            using QueueItem = std::pair<Weight, VertexId>;
+            std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+            for (VertexId vertex = 0; vertex < vertex_count; ++vertex)
+            {
+                if (states[vertex] != RouteState::BROKEN)
+                {
+                    continue;
+                }
+                weights[vertex] = UNREACHABLE_WEIGHT;
+                prev_edges[vertex] = NO_ROUTE;
+                for (size_t i = incoming_offsets[vertex]; i < incoming_offsets[vertex + 1]; ++i)
+                {
+                    const Edge<Weight> &edge = graph.GetEdge(incoming_edges[i]);
+                    if (states[edge.from] == RouteState::KEPT && prev_edges[edge.from] != NO_ROUTE &&
+                        (prev_edges[vertex] == NO_ROUTE || weights[edge.from] + edge.weight < weights[vertex]))
                     {
-                        route_internal_data = RouteInternalData{edge.weight, edge_id};
+                        weights[vertex] = weights[edge.from] + edge.weight;
+                        prev_edges[vertex] = static_cast<PrevEdge>(incoming_edges[i]);
                     }
                 }
+                if (prev_edges[vertex] != NO_ROUTE)
+                {
+                    queue.push({weights[vertex], vertex});
+                }
+            }
+            while (!queue.empty())
+            {
+                const auto [weight, vertex] = queue.top();
+                queue.pop();
+                if (weight > weights[vertex])
+                {
+                    continue;
+                }
+                graph.ForEachIncidentEdge(vertex, [weights, prev_edges, weight = weight, &is_kept_edge, &states, &queue](EdgeId edge_id, VertexId to, Weight edge_weight)
+                                          {
+                                              if (!is_kept_edge[edge_id] || states[to] != RouteState::BROKEN)
+                                              {
+                                                  return;
+                                              }
+                                              const Weight candidate_weight = weight + edge_weight;
+                                              if (prev_edges[to] == NO_ROUTE || candidate_weight < weights[to])
+                                              {
+                                                  weights[to] = candidate_weight;
+                                                  prev_edges[to] = static_cast<PrevEdge>(edge_id);
+                                                  queue.push({candidate_weight, to});
+                                              }
+                                          });
             }
         }
 
-        void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData &route_from,
-                        const RouteInternalData &route_to)
+        // The routes of every row through the edge, the table has to hold the shortest routes of the graph without it
+        void InsertEdge(EdgeId edge_id, const Edge<Weight> &edge)
         {
-            auto &route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-            const Weight candidate_weight = route_from.weight + route_to.weight;
-            if (!route_relaxing || candidate_weight < route_relaxing->weight)
+            const size_t vertex_count = routes_internal_data_.vertex_count;
+            RelaxRowArguments<Weight> arguments{};
+            arguments.count = vertex_count;
+            arguments.no_route = NO_ROUTE;
+            arguments.no_prev_edge = NO_PREV_EDGE;
+            arguments.prev_edge_from = static_cast<PrevEdge>(edge_id);
+            arguments.weights_through = &routes_internal_data_.weights[edge.to * vertex_count];
+            arguments.prev_edges_through = &routes_internal_data_.prev_edges[edge.to * vertex_count];
+            for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from)
             {
-                route_relaxing = {candidate_weight,
-                                  route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge};
+                const size_t route_from = vertex_from * vertex_count;
+                if (routes_internal_data_.prev_edges[route_from + edge.from] == NO_ROUTE)
+                {
+                    continue;
+                }
+                // a row the edge does not make the route to its end lighter in keeps all its routes
+                arguments.weight_from = routes_internal_data_.weights[route_from + edge.from] + edge.weight;
+                if (routes_internal_data_.prev_edges[route_from + edge.to] != NO_ROUTE &&
+                    !(arguments.weight_from < routes_internal_data_.weights[route_from + edge.to]))
+                {
+                    continue;
+                }
+                arguments.weights = &routes_internal_data_.weights[route_from];
+                arguments.prev_edges = &routes_internal_data_.prev_edges[route_from];
+                relax_row_(arguments);
             }
         }
 
-        void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through)
+        // Every thread owns a stripe of rows and relaxes it through each vertex in turn
+        void RelaxRows(size_t thread, size_t thread_count, Barrier &barrier)
         {
-            for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from)
+            const size_t vertex_count = routes_internal_data_.vertex_count;
+            const VertexId first_from = vertex_count * thread / thread_count;
+            const VertexId last_from = vertex_count * (thread + 1) / thread_count;
+            for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through)
             {
-                if (const auto &route_from = routes_internal_data_[vertex_from][vertex_through])
+                RelaxRoutesInternalData(first_from, last_from, 0, vertex_count, vertex_through, vertex_through + 1);
+                barrier.ArriveAndWait();
+            }
+        }
+
+        // For every diagonal tile: the tile itself is relaxed through its vertices, then the tiles of its row and column,
+        // then the rest of the table. The tiles of the last two phases are independent and are shared between the threads
+        void RelaxTiles(size_t thread, size_t thread_count, size_t tile_size, Barrier &barrier)
+        {
+            const size_t vertex_count = routes_internal_data_.vertex_count;
+            const size_t tile_count = (vertex_count + tile_size - 1) / tile_size;
+            auto tile_begin = [tile_size](size_t tile)
+            {
+                return static_cast<VertexId>(tile * tile_size);
+            };
+            auto tile_end = [tile_size, vertex_count](size_t tile)
+            {
+                return static_cast<VertexId>(std::min(vertex_count, (tile + 1) * tile_size));
+            };
+            for (size_t diagonal = 0; diagonal < tile_count; ++diagonal)
+            {
+                const VertexId first_through = tile_begin(diagonal);
+                const VertexId last_through = tile_end(diagonal);
+                if (thread == 0)
+                {
+                    RelaxRoutesInternalData(first_through, last_through, first_through, last_through, first_through, last_through);
+                }
+                barrier.ArriveAndWait();
+
+                // tiles [0, tile_count) are the row of the diagonal tile, [tile_count, 2 * tile_count) - its column
+                for (size_t tile = thread; tile < 2 * tile_count; tile += thread_count)
+                {
+                    const size_t other = tile % tile_count;
+                    if (other == diagonal)
+                    {
+                        continue;
+                    }
+                    if (tile < tile_count)
+                    {
+                        RelaxRoutesInternalData(first_through, last_through, tile_begin(other), tile_end(other), first_through, last_through);
+                    }
+                    else
+                    {
+                        RelaxRoutesInternalData(tile_begin(other), tile_end(other), first_through, last_through, first_through, last_through);
+                    }
+                }
+                barrier.ArriveAndWait();
+
+                for (size_t tile = thread; tile < tile_count * tile_count; tile += thread_count)
                 {
-                    for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to)
+                    const size_t row = tile / tile_count;
+                    const size_t column = tile % tile_count;
+                    if (row == diagonal || column == diagonal)
                     {
-                        if (const auto &route_to = routes_internal_data_[vertex_through][vertex_to])
-                        {
-                            RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
-                        }
+                        continue;
                     }
+                    RelaxRoutesInternalData(tile_begin(row), tile_end(row), tile_begin(column), tile_end(column), first_through, last_through);
                 }
+                barrier.ArriveAndWait();
             }
         }
 
         static constexpr Weight ZERO_WEIGHT{};
         const Graph &graph_;
         RoutesInternalData routes_internal_data_;
+        // the table routes are built from: routes_internal_data_ or a table of someone else
+        RoutesTableView routes_table_;
+        RelaxRowFunction<Weight> relax_row_ = RelaxRowScalar<Weight>;
     };
 
-    template <typename Weight>
-    Router<Weight>::Router(const Graph &graph)
-        : graph_(graph), routes_internal_data_(graph.GetVertexCount(),
-                                               std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+    template <typename Weight, typename Graph>
+    Router<Weight, Graph>::Router(const Graph &graph, const RoutesTableSettings &settings)
+        : graph_(graph), relax_row_(GetRelaxRowFunction<Weight>(settings.kernel.value_or(GetBestRelaxRowKernel<Weight>())))
     {
         InitializeRoutesInternalData(graph);
 
         const size_t vertex_count = graph.GetVertexCount();
-        for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through)
+        const size_t thread_count = std::clamp<size_t>(settings.thread_count, 1, std::max<size_t>(vertex_count, 1));
+        Barrier barrier(thread_count);
+        auto relax = [this, thread_count, &settings, &barrier](size_t thread)
+        {
+            if (settings.tile_size == 0)
+            {
+                RelaxRows(thread, thread_count, barrier);
+            }
+            else
+            {
+                RelaxTiles(thread, thread_count, settings.tile_size, barrier);
+            }
+        };
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count - 1);
+        for (size_t thread = 1; thread < thread_count; ++thread)
         {
-            RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+            threads.emplace_back(relax, thread);
         }
+        relax(0);
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+        routes_table_ = {vertex_count, routes_internal_data_.weights.data(), routes_internal_data_.prev_edges.data()};
     }
 
-    template <typename Weight>
-    std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
-                                                                                 VertexId to) const
+    template <typename Weight, typename Graph>
+    Router<Weight, Graph>::Router(const Graph &graph, RoutesInternalData routes_internal_data)
+        : graph_(graph), routes_internal_data_(std::move(routes_internal_data))
+    {
+        const size_t cell_count = routes_internal_data_.vertex_count * routes_internal_data_.vertex_count;
+        if (routes_internal_data_.vertex_count != graph.GetVertexCount() || routes_internal_data_.weights.size() != cell_count ||
+            routes_internal_data_.prev_edges.size() != cell_count)
+        {
+            throw std::invalid_argument("Routes table does not match the graph");
+        }
+        routes_table_ = {routes_internal_data_.vertex_count, routes_internal_data_.weights.data(), routes_internal_data_.prev_edges.data()};
+    }
+
+    template <typename Weight, typename Graph>
+    Router<Weight, Graph>::Router(const Graph &graph, const RoutesTableView &routes_table)
+        : graph_(graph), routes_table_(routes_table)
+    {
+        if (routes_table_.vertex_count != graph.GetVertexCount())
+        {
+            throw std::invalid_argument("Routes table does not match the graph");
+        }
+    }
+
+    template <typename Weight, typename Graph>
+    Router<Weight, Graph>::Router(const Graph &graph, const RoutesTableView &previous_table, const GraphUpdate &update)
+        : graph_(graph), relax_row_(GetRelaxRowFunction<Weight>(GetBestRelaxRowKernel<Weight>()))
     {
-        const auto &route_internal_data = routes_internal_data_.at(from).at(to);
-        if (!route_internal_data)
+        const size_t previous_count = previous_table.vertex_count;
+        if (update.vertices.size() != previous_count)
+        {
+            throw std::invalid_argument("Update does not match the routes table");
+        }
+        const size_t vertex_count = graph.GetVertexCount();
+        if (graph.GetEdgeCount() >= NO_PREV_EDGE)
+        {
+            throw std::length_error("Too many edges for the routes table");
+        }
+        std::vector<bool> is_kept_edge(graph.GetEdgeCount());
+        for (const EdgeId edge_id : update.edges)
+        {
+            if (edge_id != GraphUpdate::REMOVED)
+            {
+                is_kept_edge.at(edge_id) = true;
+            }
+        }
+        routes_internal_data_.vertex_count = vertex_count;
+        routes_internal_data_.weights.assign(vertex_count * vertex_count, UNREACHABLE_WEIGHT);
+        routes_internal_data_.prev_edges.assign(vertex_count * vertex_count, NO_ROUTE);
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex)
+        {
+            routes_internal_data_.weights[vertex * vertex_count + vertex] = ZERO_WEIGHT;
+            routes_internal_data_.prev_edges[vertex * vertex_count + vertex] = NO_PREV_EDGE;
+        }
+
+        // the kept edges by the vertex they go to, a broken route is searched again from the ones it can end with
+        std::vector<size_t> incoming_offsets(vertex_count + 1);
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id)
+        {
+            if (is_kept_edge[edge_id])
+            {
+                ++incoming_offsets[graph.GetEdge(edge_id).to + 1];
+            }
+        }
+        std::partial_sum(incoming_offsets.begin(), incoming_offsets.end(), incoming_offsets.begin());
+        std::vector<EdgeId> incoming_edges(incoming_offsets.back());
+        {
+            std::vector<size_t> positions(incoming_offsets.begin(), incoming_offsets.end() - 1);
+            for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id)
+            {
+                if (is_kept_edge[edge_id])
+                {
+                    incoming_edges[positions[graph.GetEdge(edge_id).to]++] = edge_id;
+                }
+            }
+        }
+
+        std::vector<RouteState> states(vertex_count);
+        for (VertexId previous_from = 0; previous_from < previous_count; ++previous_from)
+        {
+            const VertexId vertex_from = update.vertices[previous_from];
+            if (vertex_from == GraphUpdate::REMOVED)
+            {
+                continue;
+            }
+            const Weight *previous_weights = previous_table.weights + previous_from * previous_count;
+            const PrevEdge *previous_prev_edges = previous_table.prev_edges + previous_from * previous_count;
+            Weight *weights = &routes_internal_data_.weights[vertex_from * vertex_count];
+            PrevEdge *prev_edges = &routes_internal_data_.prev_edges[vertex_from * vertex_count];
+            std::fill(states.begin(), states.end(), RouteState::UNKNOWN);
+            bool is_broken = false;
+            for (VertexId previous_to = 0; previous_to < previous_count; ++previous_to)
+            {
+                const PrevEdge prev_edge = previous_prev_edges[previous_to];
+                if (prev_edge == NO_ROUTE || prev_edge == NO_PREV_EDGE)
+                {
+                    continue;
+                }
+                const EdgeId edge_id = update.edges.at(prev_edge);
+                if (edge_id == GraphUpdate::REMOVED)
+                {
+                    // the routes through a removed vertex go over its removed edges
+                    if (update.vertices[previous_to] != GraphUpdate::REMOVED)
+                    {
+                        states[update.vertices[previous_to]] = RouteState::BROKEN;
+                        is_broken = true;
+                    }
+                    continue;
+                }
+                weights[update.vertices[previous_to]] = previous_weights[previous_to];
+                prev_edges[update.vertices[previous_to]] = static_cast<PrevEdge>(edge_id);
+            }
+            if (is_broken)
+            {
+                RepairRow(graph, vertex_from, is_kept_edge, incoming_offsets, incoming_edges, states);
+            }
+        }
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id)
+        {
+            if (!is_kept_edge[edge_id])
+            {
+                InsertEdge(edge_id, graph.GetEdge(edge_id));
+            }
+        }
+        routes_table_ = {vertex_count, routes_internal_data_.weights.data(), routes_internal_data_.prev_edges.data()};
+    }
+
+    template <typename Weight, typename Graph>
+    const typename Router<Weight, Graph>::RoutesInternalData &Router<Weight, Graph>::GetRoutesInternalData() const
+    {
+        return routes_internal_data_;
+    }
+
+    template <typename Weight, typename Graph>
+    const typename Router<Weight, Graph>::RoutesTableView &Router<Weight, Graph>::GetRoutesTable() const
+    {
+        return routes_table_;
+    }
+
+    template <typename Weight, typename Graph>
+    std::optional<typename Router<Weight, Graph>::RouteInfo> Router<Weight, Graph>::BuildRoute(VertexId from,
+                                                                                               VertexId to) const
+    {
+        const size_t vertex_count = routes_table_.vertex_count;
+        if (from >= vertex_count || to >= vertex_count)
+        {
+            throw std::out_of_range("Vertex is out of range");
+        }
+        const PrevEdge *prev_edges = routes_table_.prev_edges + from * vertex_count;
+        if (prev_edges[to] == NO_ROUTE)
         {
             return std::nullopt;
         }
-        const Weight weight = route_internal_data->weight;
+        const Weight weight = routes_table_.weights[from * vertex_count + to];
         std::vector<EdgeId> edges;
-        for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-             edge_id;
-             edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+        for (PrevEdge edge_id = prev_edges[to];
+             edge_id != NO_PREV_EDGE;
+             edge_id = prev_edges[graph_.GetEdge(edge_id).from])
         {
-            edges.push_back(*edge_id);
+            edges.push_back(edge_id);
         }
         std::reverse(edges.begin(), edges.end());
 
@@ -2,53 +2,109 @@
 
 #include "serialization.h"
 
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
 namespace serialization
 {
     using namespace std::string_literals;
-    proto_catalogue::TransportCatalogue CreateProtoCatalogue(const catalogue::TransportCatalogue &transport_catalogue)
+
+    // coordinates given with up to 9 decimal digits are stored exactly as integers
+    constexpr uint32_t MAX_FIXED_POINT_DIGITS = 9;
+
+    proto_catalogue::DoubleSequence GetProtoDoubleSequence(const std::vector<double> &numbers)
     {
-        const std::unordered_map<std::string, geo::Coordinates> &stops = transport_catalogue.GetAllStops();
-        const std::unordered_map<std::string, domain::Bus> &buses = transport_catalogue.GetAllBuses();
-        const std::unordered_map<std::string_view, std::unordered_map<std::string_view, int>> &distance_between_stops = transport_catalogue.GetDistanceBetweenStops();
-        std::unordered_map<std::string_view, int> stops_id;
-        for (const auto &[name_stop, coordinates] : stops)
+        proto_catalogue::DoubleSequence proto_sequence;
+        double scale = 1;
+        for (uint32_t digits = 0; digits <= MAX_FIXED_POINT_DIGITS; ++digits, scale *= 10)
         {
-            stops_id[name_stop] = stops_id.size();
-        }
-
-        proto_catalogue::TransportCatalogue proto_catalogue;
-        for (const auto &[name_stop, coordinates] : stops)
-        {
-            proto_catalogue::Stop stop;
-            stop.set_name(name_stop);
-            stop.set_id(stops_id.at(name_stop));
-            proto_catalogue::Coordinates stop_coordinates;
-            stop_coordinates.set_lat(coordinates.lat);
-            stop_coordinates.set_lng(coordinates.lng);
-            *stop.mutable_coordinates() = std::move(stop_coordinates);
-            if (distance_between_stops.count(name_stop))
+            std::vector<int64_t> fixed_point;
+            fixed_point.reserve(numbers.size());
+            for (const double number : numbers)
+            {
+                const double scaled = std::round(number * scale);
+                // beyond 2^53 not every integer is a double, and the sign of zero would be lost
+                if (!(std::abs(scaled) < 9e15) || scaled / scale != number || (number == 0 && std::signbit(number)))
+                {
+                    break;
+                }
+                fixed_point.push_back(static_cast<int64_t>(scaled));
+            }
+            if (fixed_point.size() == numbers.size())
             {
-                for (const auto &[name, dist] : distance_between_stops.at(name_stop))
+                proto_sequence.set_is_fixed_point(true);
+                proto_sequence.set_digits(digits);
+                proto_sequence.mutable_deltas()->Reserve(fixed_point.size());
+                int64_t previous = 0;
+                for (const int64_t value : fixed_point)
                 {
-                    proto_catalogue::DistanceToStops distance_to_stops;
-                    distance_to_stops.set_stop_to_id(stops_id.at(name));
-                    distance_to_stops.set_distance(dist);
-                    stop.add_distance_to_stops()->CopyFrom(distance_to_stops);
+                    proto_sequence.add_deltas(value - previous);
+                    previous = value;
                 }
+                return proto_sequence;
             }
-            proto_catalogue.add_stops()->CopyFrom(stop);
         }
+        *proto_sequence.mutable_values() = {numbers.begin(), numbers.end()};
+        return proto_sequence;
+    }
+
+    proto_catalogue::TransportCatalogue CreateProtoCatalogue(const catalogue::TransportCatalogue &transport_catalogue)
+    {
+        proto_catalogue::TransportCatalogue proto_catalogue;
+        const std::deque<domain::Stop> &stops = transport_catalogue.GetAllStops();
+        const std::deque<domain::Bus> &buses = transport_catalogue.GetAllBuses();
+
+        proto_catalogue::StopTable &stop_table = *proto_catalogue.mutable_stop_table();
+        std::vector<double> latitudes;
+        std::vector<double> longitudes;
+        latitudes.reserve(stops.size());
+        longitudes.reserve(stops.size());
+        for (const domain::Stop &stop : stops)
+        {
+            stop_table.add_names(stop.name);
+            latitudes.push_back(stop.coordinates.lat);
+            longitudes.push_back(stop.coordinates.lng);
+        }
+        *stop_table.mutable_latitudes() = GetProtoDoubleSequence(latitudes);
+        *stop_table.mutable_longitudes() = GetProtoDoubleSequence(longitudes);
 
-        for (const auto &[name_bus, bus_info] : buses)
+        // the layout of the hash table depends on the history of the insertions, the pairs of ids do not
+        std::vector<std::tuple<domain::StopId, domain::StopId, int>> distances;
+        distances.reserve(transport_catalogue.GetDistanceBetweenStops().size());
+        transport_catalogue.GetDistanceBetweenStops().ForEach([&distances](domain::StopId stop_from, domain::StopId stop_to, int distance)
+                                                              { distances.emplace_back(stop_from, stop_to, distance); });
+        std::sort(distances.begin(), distances.end());
+        proto_catalogue::DistanceTable &distance_table = *proto_catalogue.mutable_distance_table();
+        int64_t previous_from = 0;
+        int64_t previous_to = 0;
+        for (const auto &[stop_from, stop_to, distance] : distances)
         {
-            proto_catalogue::Bus bus;
-            bus.set_name(std::string{name_bus});
-            bus.set_is_circular(bus_info.is_circular);
-            for (const auto &stop : bus_info.stops)
+            distance_table.add_stop_from_deltas(stop_from - previous_from);
+            distance_table.add_stop_to_deltas(stop_to - previous_to);
+            distance_table.add_distances(distance);
+            previous_from = stop_from;
+            previous_to = stop_to;
+        }
+
+        proto_catalogue::BusTable &bus_table = *proto_catalogue.mutable_bus_table();
+        int64_t previous_stop = 0;
+        for (domain::BusId id = 0; id < buses.size(); ++id)
+        {
+            const domain::Bus &bus = buses[id];
+            bus_table.add_names(bus.name);
+            bus_table.add_is_circular(bus.is_circular);
+            bus_table.add_stop_counts(bus.stops.size());
+            for (const domain::StopId stop : bus.stops)
             {
-                bus.add_stops(stops_id.at(stop.first));
+                bus_table.add_stop_deltas(stop - previous_stop);
+                previous_stop = stop;
             }
-            proto_catalogue.add_buses()->CopyFrom(bus);
+            const domain::BusStatistics &statistics = transport_catalogue.GetBusStatistics(id);
+            bus_table.add_stops_on_route(statistics.stops_on_route);
+            bus_table.add_unique_stop_counts(statistics.unique_stops);
+            bus_table.add_route_lengths(statistics.route_length);
+            bus_table.add_curvatures(statistics.curvature);
         }
         return proto_catalogue;
     }
@@ -108,52 +164,194 @@ namespace serialization
         return proto_render_settings;
     }
 
+    proto_tr_router::RouterType GetProtoRouterType(catalogue::tr_router::RouterType router_type)
+    {
+        if (router_type == catalogue::tr_router::RouterType::DIJKSTRA)
+        {
+            return proto_tr_router::DIJKSTRA;
+        }
+        else if (router_type == catalogue::tr_router::RouterType::CONTRACTION_HIERARCHIES)
+        {
+            return proto_tr_router::CONTRACTION_HIERARCHIES;
+        }
+        return proto_tr_router::ALL_PAIRS;
+    }
+
     proto_tr_router::TransportRouter CreateProtoTransportRouter(const catalogue::tr_router::TransoprtRouter &transport_router)
     {
         proto_tr_router::TransportRouter proto_router;
-        std::unordered_map<std::string_view, size_t> buses_id;
-        std::unordered_map<std::string_view, size_t> stops_id;
 
         proto_router.set_bus_wait_time(transport_router.GetBusWaitTime());
-        const std::unordered_map<size_t, domain::EdgeInfo> &edges_info = transport_router.GetEdgesInfo();
-        for (const auto &[_, edge_info] : edges_info)
+        proto_router.set_router_type(GetProtoRouterType(transport_router.GetRouterType()));
+        proto_router.set_bus_velocity(transport_router.GetBusVelocity());
+        if (transport_router.GetGraphModel() == catalogue::tr_router::GraphModel::RIDE_SEGMENTS)
         {
-            proto_tr_router::EdgeInfo proto_edge_info;
-            if (!buses_id.count(edge_info.name_bus))
+            // the ride segments graph is linear in the size of the catalogue and is rebuilt on load
+            proto_router.set_graph_model(proto_tr_router::RIDE_SEGMENTS);
+            return proto_router;
+        }
+        // the edges refer to the stops and the buses by the ids of the catalogue stored in the same base, every column
+        // is stored as the differences from the previous edge, which are small for the edges of one bus
+        proto_tr_router::EdgeTable &edge_table = *proto_router.mutable_edge_table();
+        const size_t edge_count = transport_router.GetEdgeCount();
+        edge_table.mutable_bus_deltas()->Reserve(edge_count);
+        edge_table.mutable_stop_from_deltas()->Reserve(edge_count);
+        edge_table.mutable_stop_to_deltas()->Reserve(edge_count);
+        edge_table.mutable_span_counts()->Reserve(edge_count);
+        edge_table.mutable_times()->Reserve(edge_count);
+        domain::EdgeRecord previous{};
+        for (size_t edge_id = 0; edge_id < edge_count; ++edge_id)
+        {
+            const domain::EdgeRecord &record = transport_router.GetEdgeRecord(edge_id);
+            edge_table.add_bus_deltas(static_cast<int64_t>(record.bus) - previous.bus);
+            edge_table.add_stop_from_deltas(static_cast<int64_t>(record.stop_from) - previous.stop_from);
+            edge_table.add_stop_to_deltas(static_cast<int64_t>(record.stop_to) - previous.stop_to);
+            edge_table.add_span_counts(record.span_count);
+            edge_table.add_times(record.time);
+            previous = record;
+        }
+        return proto_router;
+    }
+
+    proto_tr_router::RoutesTable CreateProtoRoutesTable(const graph::Router<double> &router)
+    {
+        proto_tr_router::RoutesTable proto_routes_table;
+        const graph::Router<double>::RoutesInternalData &routes_internal_data = router.GetRoutesInternalData();
+        proto_routes_table.set_vertex_count(routes_internal_data.vertex_count);
+        proto_routes_table.mutable_prev_edges()->Reserve(routes_internal_data.prev_edges.size());
+        for (size_t cell = 0; cell < routes_internal_data.prev_edges.size(); ++cell)
+        {
+            // 0 - no route, 1 - route without edges, otherwise prev_edge + 2
+            const uint32_t prev_edge = routes_internal_data.prev_edges[cell];
+            if (prev_edge == graph::Router<double>::NO_ROUTE)
             {
-                proto_tr_router::Bus proto_bus;
-                proto_bus.set_id(buses_id.size());
-                proto_bus.set_name(std::string{edge_info.name_bus});
-                proto_router.add_buses()->CopyFrom(proto_bus);
-                buses_id[edge_info.name_bus] = buses_id.size();
+                proto_routes_table.add_prev_edges(0);
+                continue;
             }
-            proto_edge_info.set_bus(buses_id.at(edge_info.name_bus));
-            proto_edge_info.set_span_count(edge_info.span_count);
-            proto_edge_info.set_time(edge_info.time);
-            if (!stops_id.count(edge_info.stop_from))
+            proto_routes_table.add_prev_edges(prev_edge == graph::Router<double>::NO_PREV_EDGE ? 1 : prev_edge + 2);
+            proto_routes_table.add_weights(routes_internal_data.weights[cell]);
+        }
+        return proto_routes_table;
+    }
+
+    proto_tr_router::ContractionHierarchy CreateProtoContractionHierarchy(const graph::ContractionHierarchy<double> &router)
+    {
+        proto_tr_router::ContractionHierarchy proto_hierarchy;
+        for (const size_t rank : router.GetRanks())
+        {
+            proto_hierarchy.add_ranks(rank);
+        }
+        for (const auto &shortcut : router.GetShortcuts())
+        {
+            proto_hierarchy.add_shortcut_first(shortcut.first);
+            proto_hierarchy.add_shortcut_second(shortcut.second);
+        }
+        return proto_hierarchy;
+    }
+
+    std::vector<double> GetDoubleSequence(const proto_catalogue::DoubleSequence &proto_sequence)
+    {
+        if (!proto_sequence.is_fixed_point())
+        {
+            return {proto_sequence.values().begin(), proto_sequence.values().end()};
+        }
+        if (proto_sequence.digits() > MAX_FIXED_POINT_DIGITS)
+        {
+            throw std::invalid_argument("Corrupted number sequence"s);
+        }
+        double scale = 1;
+        for (uint32_t digit = 0; digit < proto_sequence.digits(); ++digit)
+        {
+            scale *= 10;
+        }
+        std::vector<double> numbers;
+        numbers.reserve(proto_sequence.deltas_size());
+        int64_t value = 0;
+        for (const int64_t delta : proto_sequence.deltas())
+        {
+            value += delta;
+            numbers.push_back(value / scale);
+        }
+        return numbers;
+    }
+
+    catalogue::TransportCatalogue DeserializeCatalogue(const proto_catalogue::TransportCatalogue &proto_catalogue)
+    {
+        if (!proto_catalogue.has_stop_table())
+        {
+            return DeserializeCatalogueMessages(proto_catalogue);
+        }
+        catalogue::TransportCatalogue transport_catalogue;
+        const proto_catalogue::StopTable &stop_table = proto_catalogue.stop_table();
+        const std::vector<double> latitudes = GetDoubleSequence(stop_table.latitudes());
+        const std::vector<double> longitudes = GetDoubleSequence(stop_table.longitudes());
+        if (latitudes.size() != static_cast<size_t>(stop_table.names_size()) || longitudes.size() != latitudes.size())
+        {
+            throw std::invalid_argument("Corrupted stop table"s);
+        }
+        for (int stop = 0; stop < stop_table.names_size(); ++stop)
+        {
+            domain::StopInputInfo stop_info;
+            stop_info.name_stop = stop_table.names(stop);
+            stop_info.coordinates = {latitudes[stop], longitudes[stop]};
+            transport_catalogue.AddStop(std::move(stop_info));
+        }
+
+        const proto_catalogue::DistanceTable &distance_table = proto_catalogue.distance_table();
+        if (distance_table.stop_from_deltas_size() != distance_table.distances_size() || distance_table.stop_to_deltas_size() != distance_table.distances_size())
+        {
+            throw std::invalid_argument("Corrupted distance table"s);
+        }
+        int64_t stop_from = 0;
+        int64_t stop_to = 0;
+        for (int distance = 0; distance < distance_table.distances_size(); ++distance)
+        {
+            stop_from += distance_table.stop_from_deltas(distance);
+            stop_to += distance_table.stop_to_deltas(distance);
+            if (stop_from < 0 || stop_to < 0)
             {
-                proto_tr_router::Stop proto_stop;
-                proto_stop.set_id(stops_id.size());
-                proto_stop.set_name(std::string{edge_info.stop_from});
-                proto_router.add_stops()->CopyFrom(proto_stop);
-                stops_id[edge_info.stop_from] = stops_id.size();
+                throw std::invalid_argument("Corrupted distance table"s);
             }
-            proto_edge_info.set_stop_from(stops_id.at(edge_info.stop_from));
-            if (!stops_id.count(edge_info.stop_to))
+            transport_catalogue.SetDistanceBetweenStops(stop_from, stop_to, distance_table.distances(distance));
+        }
+
+        const proto_catalogue::BusTable &bus_table = proto_catalogue.bus_table();
+        const int bus_count = bus_table.names_size();
+        if (bus_table.is_circular_size() != bus_count || bus_table.stop_counts_size() != bus_count || bus_table.stops_on_route_size() != bus_count ||
+            bus_table.unique_stop_counts_size() != bus_count || bus_table.route_lengths_size() != bus_count || bus_table.curvatures_size() != bus_count)
+        {
+            throw std::invalid_argument("Corrupted bus table"s);
+        }
+        int next_stop = 0;
+        int64_t stop = 0;
+        for (int index = 0; index < bus_count; ++index)
+        {
+            domain::Bus bus;
+            bus.name = bus_table.names(index);
+            bus.is_circular = bus_table.is_circular(index);
+            if (bus_table.stop_counts(index) > static_cast<uint32_t>(bus_table.stop_deltas_size() - next_stop))
             {
-                proto_tr_router::Stop proto_stop;
-                proto_stop.set_id(stops_id.size());
-                proto_stop.set_name(std::string{edge_info.stop_to});
-                proto_router.add_stops()->CopyFrom(proto_stop);
-                stops_id[edge_info.stop_to] = stops_id.size();
+                throw std::invalid_argument("Corrupted bus table"s);
             }
-            proto_edge_info.set_stop_to(stops_id.at(edge_info.stop_to));
-            proto_router.add_edges_info()->CopyFrom(proto_edge_info);
+            bus.stops.reserve(bus_table.stop_counts(index));
+            for (uint32_t i = 0; i < bus_table.stop_counts(index); ++i)
+            {
+                stop += bus_table.stop_deltas(next_stop++);
+                if (stop < 0)
+                {
+                    throw std::invalid_argument("Corrupted bus table"s);
+                }
+                bus.stops.push_back(stop);
+            }
+            const domain::BusId id = transport_catalogue.AddBus(std::move(bus));
+            transport_catalogue.SetBusStatistics(id, {bus_table.stops_on_route(index), bus_table.unique_stop_counts(index),
+                                                      bus_table.route_lengths(index), bus_table.curvatures(index)});
         }
-        return proto_router;
+        transport_catalogue.Finalize();
+        return transport_catalogue;
     }
 
-    catalogue::TransportCatalogue DeserializeCatalogue(const proto_catalogue::TransportCatalogue &proto_catalogue)
+    catalogue::TransportCatalogue DeserializeCatalogueMessages(const proto_catalogue::TransportCatalogue &proto_catalogue)
     {
         catalogue::TransportCatalogue transport_catalogue;
         std::unordered_map<int, std::string> id_stops;
@@ -187,8 +385,15 @@ namespace serialization
             {
                 bus_info.stops.push_back(id_stops.at(stop));
             }
-            transport_catalogue.AddBus(bus_info);
+            const domain::BusId id = transport_catalogue.AddBus(bus_info);
+            // bases made before the statistics were stored get them computed by Finalize
+            if (bus.has_statistics())
+            {
+                transport_catalogue.SetBusStatistics(id, {bus.statistics().stop_count(), bus.statistics().unique_stop_count(),
+                                                          bus.statistics().route_length(), bus.statistics().curvature()});
+            }
         }
+        transport_catalogue.Finalize();
         return transport_catalogue;
     }
 
@@ -246,39 +451,193 @@ namespace serialization
         return render_settings;
     }
 
-    using Graph = graph::DirectedWeightedGraph<double>;
+    catalogue::tr_router::RouterType GetRouterType(proto_tr_router::RouterType proto_router_type)
+    {
+        if (proto_router_type == proto_tr_router::DIJKSTRA)
+        {
+            return catalogue::tr_router::RouterType::DIJKSTRA;
+        }
+        else if (proto_router_type == proto_tr_router::CONTRACTION_HIERARCHIES)
+        {
+            return catalogue::tr_router::RouterType::CONTRACTION_HIERARCHIES;
+        }
+        return catalogue::tr_router::RouterType::ALL_PAIRS;
+    }
+
+    using FrozenGraph = graph::CsrGraph<double>;
+
+    FrozenGraph DeserializeTransportRouter(const proto_tr_router::TransportRouter &proto_router, catalogue::tr_router::TransoprtRouter &tr_router)
+    {
+        double bus_wait_time = proto_router.bus_wait_time();
+        tr_router.SetBusWaitTime(bus_wait_time);
+        tr_router.SetRouterType(GetRouterType(proto_router.router_type()));
+        tr_router.SetBusVelocity(proto_router.bus_velocity());
+        if (proto_router.graph_model() == proto_tr_router::RIDE_SEGMENTS)
+        {
+            tr_router.SetGraphModel(catalogue::tr_router::GraphModel::RIDE_SEGMENTS);
+            return FrozenGraph(tr_router.CreateGraph());
+        }
+        std::vector<domain::EdgeRecord> records = proto_router.has_edge_table() ? DeserializeEdgeTable(proto_router.edge_table(), tr_router)
+                                                                                : DeserializeEdgeMessages(proto_router, tr_router);
+        std::vector<graph::Edge<double>> edges(records.size());
+        for (size_t edge_id = 0; edge_id < records.size(); ++edge_id)
+        {
+            const domain::EdgeRecord &record = records[edge_id];
+            edges[edge_id] = {tr_router.GetVertexId(record.stop_from), tr_router.GetVertexId(record.stop_to), record.time + bus_wait_time};
+        }
+        tr_router.SetEdgeRecords(std::move(records));
+        return FrozenGraph(tr_router.GetStopsCount(), edges);
+    }
+
+    std::vector<domain::EdgeRecord> DeserializeEdgeTable(const proto_tr_router::EdgeTable &proto_edge_table,
+                                                         const catalogue::tr_router::TransoprtRouter &tr_router)
+    {
+        const int edge_count = proto_edge_table.times_size();
+        if (proto_edge_table.bus_deltas_size() != edge_count || proto_edge_table.stop_from_deltas_size() != edge_count ||
+            proto_edge_table.stop_to_deltas_size() != edge_count || proto_edge_table.span_counts_size() != edge_count)
+        {
+            throw std::invalid_argument("Corrupted edge table"s);
+        }
+        const int64_t bus_count = tr_router.GetTransoprtCatalogue().GetAllBuses().size();
+        const int64_t stop_count = tr_router.GetTransoprtCatalogue().GetAllStops().size();
+        std::vector<domain::EdgeRecord> records(edge_count);
+        int64_t bus = 0;
+        int64_t stop_from = 0;
+        int64_t stop_to = 0;
+        for (int edge_id = 0; edge_id < edge_count; ++edge_id)
+        {
+            bus += proto_edge_table.bus_deltas(edge_id);
+            stop_from += proto_edge_table.stop_from_deltas(edge_id);
+            stop_to += proto_edge_table.stop_to_deltas(edge_id);
+            if (bus < 0 || bus >= bus_count || stop_from < 0 || stop_from >= stop_count || stop_to < 0 || stop_to >= stop_count)
+            {
+                throw std::invalid_argument("Corrupted edge table"s);
+            }
+            records[edge_id] = {static_cast<domain::BusId>(bus), static_cast<domain::StopId>(stop_from), static_cast<domain::StopId>(stop_to),
+                                proto_edge_table.span_counts(edge_id), proto_edge_table.times(edge_id)};
+        }
+        return records;
+    }
 
-    Graph DeserializeTransportRouter(const proto_tr_router::TransportRouter &proto_router, catalogue::tr_router::TransoprtRouter &tr_router)
+    std::vector<domain::EdgeRecord> DeserializeEdgeMessages(const proto_tr_router::TransportRouter &proto_router,
+                                                            const catalogue::tr_router::TransoprtRouter &tr_router)
     {
-        std::unordered_map<size_t, std::string_view> buses_id;
-        std::unordered_map<size_t, std::string_view> stops_id;
+        // bases made before the edges referred to the catalogue have their own numbering, it is resolved by name once
+        const catalogue::TransportCatalogue &transport_catalogue = tr_router.GetTransoprtCatalogue();
+        const bool has_own_ids = proto_router.stops_size() > 0;
+        std::unordered_map<size_t, domain::BusId> buses_id;
+        std::unordered_map<size_t, domain::StopId> stops_id;
         for (const auto &stop : proto_router.stops())
         {
-            stops_id[stop.id()] = stop.name();
+            stops_id[stop.id()] = transport_catalogue.FindStopId(stop.name()).value();
         }
         for (const auto &bus : proto_router.buses())
         {
-            buses_id[bus.id()] = bus.name();
+            buses_id[bus.id()] = transport_catalogue.FindBusId(bus.name()).value();
         }
-        double bus_wait_time = proto_router.bus_wait_time();
-        tr_router.SetBusWaitTime(bus_wait_time);
-        const std::unordered_map<std::string, geo::Coordinates> &stops = tr_router.GetTransoprtCatalogue().GetAllStops();
-        const std::unordered_map<std::string, domain::Bus> &buses = tr_router.GetTransoprtCatalogue().GetAllBuses();
-        Graph graph(stops_id.size());
-        for (const auto &proto_edge_info : proto_router.edges_info())
-        {
-            domain::EdgeInfo edge_info;
-            edge_info.span_count = proto_edge_info.span_count();
-            edge_info.time = proto_edge_info.time();
-            edge_info.name_bus = buses.find(std::string{buses_id.at(proto_edge_info.bus())})->first;
-            edge_info.stop_from = stops.find(std::string{stops_id.at(proto_edge_info.stop_from())})->first;
-            edge_info.stop_to = stops.find(std::string{stops_id.at(proto_edge_info.stop_to())})->first;
-            graph::Edge<double> edge;
-            edge.from = tr_router.GetStopId(edge_info.stop_from);
-            edge.to = tr_router.GetStopId(edge_info.stop_to);
-            edge.weight = edge_info.time + bus_wait_time;
-            tr_router.AddEdgeInfo(graph.AddEdge(edge), edge_info);
-        }
-        return graph;
+        const size_t bus_count = transport_catalogue.GetAllBuses().size();
+        std::vector<domain::EdgeRecord> records(proto_router.edges_info_size());
+        for (size_t edge_id = 0; edge_id < records.size(); ++edge_id)
+        {
+            const proto_tr_router::EdgeInfo &proto_edge_info = proto_router.edges_info(edge_id);
+            domain::EdgeRecord &record = records[edge_id];
+            if (has_own_ids)
+            {
+                record.bus = buses_id.at(proto_edge_info.bus());
+                record.stop_from = stops_id.at(proto_edge_info.stop_from());
+                record.stop_to = stops_id.at(proto_edge_info.stop_to());
+            }
+            else
+            {
+                record.bus = proto_edge_info.bus();
+                record.stop_from = proto_edge_info.stop_from();
+                record.stop_to = proto_edge_info.stop_to();
+                if (record.bus >= bus_count)
+                {
+                    throw std::invalid_argument("Corrupted transport router"s);
+                }
+            }
+            record.span_count = proto_edge_info.span_count();
+            record.time = proto_edge_info.time();
+        }
+        return records;
+    }
+
+    graph::Router<double>::RoutesInternalData DeserializeRoutesTable(const proto_tr_router::RoutesTable &proto_routes_table)
+    {
+        const size_t vertex_count = proto_routes_table.vertex_count();
+        if (static_cast<size_t>(proto_routes_table.prev_edges_size()) != vertex_count * vertex_count)
+        {
+            throw std::invalid_argument("Corrupted routes table"s);
+        }
+        graph::Router<double>::RoutesInternalData routes_internal_data;
+        routes_internal_data.vertex_count = vertex_count;
+        routes_internal_data.weights.assign(vertex_count * vertex_count, graph::Router<double>::UNREACHABLE_WEIGHT);
+        routes_internal_data.prev_edges.assign(vertex_count * vertex_count, graph::Router<double>::NO_ROUTE);
+        int weight_index = 0;
+        for (size_t cell = 0; cell < vertex_count * vertex_count; ++cell)
+        {
+            const uint32_t prev_edge = proto_routes_table.prev_edges(cell);
+            if (prev_edge == 0)
+            {
+                continue;
+            }
+            if (weight_index == proto_routes_table.weights_size())
+            {
+                throw std::invalid_argument("Corrupted routes table"s);
+            }
+            routes_internal_data.weights[cell] = proto_routes_table.weights(weight_index++);
+            routes_internal_data.prev_edges[cell] = prev_edge == 1 ? graph::Router<double>::NO_PREV_EDGE : prev_edge - 2;
+        }
+        return routes_internal_data;
+    }
+
+    std::unique_ptr<graph::ContractionHierarchy<double>> DeserializeContractionHierarchy(const proto_tr_router::ContractionHierarchy &proto_hierarchy,
+                                                                                         const FrozenGraph &graph)
+    {
+        if (proto_hierarchy.shortcut_first_size() != proto_hierarchy.shortcut_second_size())
+        {
+            throw std::invalid_argument("Corrupted contraction hierarchy"s);
+        }
+        std::vector<size_t> ranks(proto_hierarchy.ranks().begin(), proto_hierarchy.ranks().end());
+        std::vector<graph::ContractionHierarchy<double>::Shortcut> shortcuts;
+        shortcuts.reserve(proto_hierarchy.shortcut_first_size());
+        for (int i = 0; i < proto_hierarchy.shortcut_first_size(); ++i)
+        {
+            shortcuts.push_back({proto_hierarchy.shortcut_first(i), proto_hierarchy.shortcut_second(i)});
+        }
+        return std::make_unique<graph::ContractionHierarchy<double>>(graph, std::move(ranks), std::move(shortcuts));
+    }
+
+    void SaveProtoBase(std::ostream &output, const catalogue::renderer::MapRenderer::RenderSettings &render_settings,
+                       const catalogue::tr_router::TransoprtRouter &transport_router, const graph::RouterBase<double> &router)
+    {
+        proto_catalogue::TransportNavigator transport_navigator;
+        *transport_navigator.mutable_catalogue() = CreateProtoCatalogue(transport_router.GetTransoprtCatalogue());
+        *transport_navigator.mutable_render_settings() = CreateProtoRenderSettings(render_settings);
+        *transport_navigator.mutable_transport_router() = CreateProtoTransportRouter(transport_router);
+        if (const auto *all_pairs = dynamic_cast<const graph::Router<double> *>(&router))
+        {
+            *transport_navigator.mutable_transport_router()->mutable_routes_table() = CreateProtoRoutesTable(*all_pairs);
+        }
+        else if (const auto *hierarchy = dynamic_cast<const graph::ContractionHierarchy<double> *>(&router))
+        {
+            *transport_navigator.mutable_transport_router()->mutable_contraction_hierarchy() = CreateProtoContractionHierarchy(*hierarchy);
+        }
+        transport_navigator.SerializeToOstream(&output);
+    }
+
+    std::unique_ptr<graph::RouterBase<double>> DeserializeRouter(const proto_tr_router::TransportRouter &proto_router,
+                                                                 const catalogue::tr_router::TransoprtRouter &tr_router, const FrozenGraph &graph)
+    {
+        if (tr_router.GetRouterType() == catalogue::tr_router::RouterType::ALL_PAIRS && proto_router.has_routes_table())
+        {
+            return std::make_unique<graph::Router<double>>(graph, DeserializeRoutesTable(proto_router.routes_table()));
+        }
+        else if (tr_router.GetRouterType() == catalogue::tr_router::RouterType::CONTRACTION_HIERARCHIES && proto_router.has_contraction_hierarchy())
+        {
+            return DeserializeContractionHierarchy(proto_router.contraction_hierarchy(), graph);
+        }
+        return tr_router.CreateRouter(graph);
     }
 }
\ No newline at end of file
@@ -4,28 +4,65 @@
 #include <map_renderer.pb.h>
 
 #include "transport_router.h"
+#include "contraction_hierarchy.h"
 #include "map_renderer.h"
 
 #include <fstream>
 
 namespace serialization
 {
+    // Numbers with few decimal digits go as fixed point differences from the previous one, the rest as they are
+    proto_catalogue::DoubleSequence GetProtoDoubleSequence(const std::vector<double> &numbers);
+
+    // The tables of the base follow the ids of the catalogue, which make_base numbers in the order of the names
     proto_catalogue::TransportCatalogue CreateProtoCatalogue(const catalogue::TransportCatalogue &transport_catalogue);
 
     proto_svg::Color GetProtoColor(const svg::Color &color);
 
     proto_map_renderer::RenderSettings CreateProtoRenderSettings(const catalogue::renderer::MapRenderer::RenderSettings &render_settings);
 
+    proto_tr_router::RouterType GetProtoRouterType(catalogue::tr_router::RouterType router_type);
+
     proto_tr_router::TransportRouter CreateProtoTransportRouter(const catalogue::tr_router::TransoprtRouter &transport_router);
 
+    proto_tr_router::RoutesTable CreateProtoRoutesTable(const graph::Router<double> &router);
+
+    proto_tr_router::ContractionHierarchy CreateProtoContractionHierarchy(const graph::ContractionHierarchy<double> &router);
+
+    std::vector<double> GetDoubleSequence(const proto_catalogue::DoubleSequence &proto_sequence);
+
     catalogue::TransportCatalogue DeserializeCatalogue(const proto_catalogue::TransportCatalogue &proto_catalogue);
 
+    // Bases made before the tables keep a message per stop and per bus
+    catalogue::TransportCatalogue DeserializeCatalogueMessages(const proto_catalogue::TransportCatalogue &proto_catalogue);
+
     svg::Color GetColor(proto_svg::Color proto_color);
 
     catalogue::renderer::MapRenderer::RenderSettings DeserializeMapRenderer(const proto_map_renderer::RenderSettings &proto_render_settings);
 
-    using Graph = graph::DirectedWeightedGraph<double>;
+    catalogue::tr_router::RouterType GetRouterType(proto_tr_router::RouterType proto_router_type);
+
+    using FrozenGraph = graph::CsrGraph<double>;
+
+    FrozenGraph DeserializeTransportRouter(const proto_tr_router::TransportRouter &proto_router, catalogue::tr_router::TransoprtRouter &tr_router);
+
+    std::vector<domain::EdgeRecord> DeserializeEdgeTable(const proto_tr_router::EdgeTable &proto_edge_table,
+                                                         const catalogue::tr_router::TransoprtRouter &tr_router);
+
+    // Bases made before the edge table keep a message per edge
+    std::vector<domain::EdgeRecord> DeserializeEdgeMessages(const proto_tr_router::TransportRouter &proto_router,
+                                                            const catalogue::tr_router::TransoprtRouter &tr_router);
+
+    graph::Router<double>::RoutesInternalData DeserializeRoutesTable(const proto_tr_router::RoutesTable &proto_routes_table);
+
+    std::unique_ptr<graph::ContractionHierarchy<double>> DeserializeContractionHierarchy(const proto_tr_router::ContractionHierarchy &proto_hierarchy,
+                                                                                         const FrozenGraph &graph);
+
+    // The routes table or the hierarchy is stored when the router is the one of the graph model, as in SaveFlatBase
+    void SaveProtoBase(std::ostream &output, const catalogue::renderer::MapRenderer::RenderSettings &render_settings,
+                       const catalogue::tr_router::TransoprtRouter &transport_router, const graph::RouterBase<double> &router);
 
-    Graph DeserializeTransportRouter(const proto_tr_router::TransportRouter &proto_router, catalogue::tr_router::TransoprtRouter &tr_router);
+    std::unique_ptr<graph::RouterBase<double>> DeserializeRouter(const proto_tr_router::TransportRouter &proto_router,
+                                                                 const catalogue::tr_router::TransoprtRouter &tr_router, const FrozenGraph &graph);
 
 }
\ No newline at end of file
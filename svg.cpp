@@ -5,24 +5,24 @@ namespace svg
 
     using namespace std::literals;
 
-    void OstreamColorPrinter::operator()(std::monostate) const
+    void ColorPrinter::operator()(std::monostate) const
     {
         out << "none"sv;
     }
-    void OstreamColorPrinter::operator()(std::string color) const
+    void ColorPrinter::operator()(const std::string &color) const
     {
         out << color;
     }
-    void OstreamColorPrinter::operator()(Rgb color) const
+    void ColorPrinter::operator()(Rgb color) const
     {
         out << "rgb("sv << unsigned(color.red) << ","sv << unsigned(color.green) << ","sv << unsigned(color.blue) << ")"sv;
     }
-    void OstreamColorPrinter::operator()(Rgba color) const
+    void ColorPrinter::operator()(Rgba color) const
     {
         out << "rgba("sv << unsigned(color.red) << ","sv << unsigned(color.green) << ","sv << unsigned(color.blue) << ","sv << color.opacity << ")"sv;
     }
 
-    std::ostream &operator<<(std::ostream &out, const StrokeLineJoin &stroke_line_join)
+    output::Buffer &operator<<(output::Buffer &out, const StrokeLineJoin &stroke_line_join)
     {
         if (stroke_line_join == StrokeLineJoin::ARCS)
         {
@@ -47,7 +47,7 @@ namespace svg
         return out;
     }
 
-    std::ostream &operator<<(std::ostream &out, const StrokeLineCap &stroke_line_cap)
+    output::Buffer &operator<<(output::Buffer &out, const StrokeLineCap &stroke_line_cap)
     {
         if (stroke_line_cap == StrokeLineCap::BUTT)
         {
@@ -70,7 +70,7 @@ namespace svg
 
         RenderObject(context);
 
-        context.out << std::endl;
+        context.out << '\n';
     }
 
     // ---------- Circle ------------------
@@ -189,10 +189,11 @@ namespace svg
         objects_.push_back(std::move(obj));
     }
 
-    void Document::Render(std::ostream &out) const
+    void Document::Render(std::ostream &stream) const
     {
-        out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"sv << std::endl;
-        out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">"sv << std::endl;
+        output::Buffer out(stream);
+        out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"sv << '\n';
+        out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">"sv << '\n';
         RenderContext ctx(out, 2, 2);
         for (const auto &obj : objects_)
         {
@@ -8,6 +8,8 @@
 #include <optional>
 #include <variant>
 
+#include "output_buffer.h"
+
 namespace svg
 {
     struct Point
@@ -23,12 +25,12 @@ namespace svg
 
     struct RenderContext
     {
-        RenderContext(std::ostream &out)
+        RenderContext(output::Buffer &out)
             : out(out)
         {
         }
 
-        RenderContext(std::ostream &out, int indent_step, int indent = 0)
+        RenderContext(output::Buffer &out, int indent_step, int indent = 0)
             : out(out), indent_step(indent_step), indent(indent)
         {
         }
@@ -40,13 +42,10 @@ namespace svg
 
         void RenderIndent() const
         {
-            for (int i = 0; i < indent; ++i)
-            {
-                out.put(' ');
-            }
+            out.Fill(' ', indent);
         }
 
-        std::ostream &out;
+        output::Buffer &out;
         int indent_step = 0;
         int indent = 0;
     };
@@ -98,22 +97,22 @@ namespace svg
 
     inline const Color NoneColor{"none"};
 
-    struct OstreamColorPrinter
+    struct ColorPrinter
     {
-        std::ostream &out;
+        output::Buffer &out;
 
         void operator()(std::monostate) const;
 
-        void operator()(std::string color) const;
+        void operator()(const std::string &color) const;
 
         void operator()(Rgb color) const;
 
         void operator()(Rgba color) const;
     };
 
-    std::ostream &operator<<(std::ostream &out, const StrokeLineJoin &stroke_line_join);
+    output::Buffer &operator<<(output::Buffer &out, const StrokeLineJoin &stroke_line_join);
 
-    std::ostream &operator<<(std::ostream &out, const StrokeLineCap &stroke_line_cap);
+    output::Buffer &operator<<(output::Buffer &out, const StrokeLineCap &stroke_line_cap);
 
     template <typename Owner>
     class PathProps
@@ -151,20 +150,20 @@ namespace svg
     protected:
         ~PathProps() = default;
 
-        void RenderAttrs(std::ostream &out) const
+        void RenderAttrs(output::Buffer &out) const
         {
             using namespace std::literals;
 
             if (fill_color_)
             {
                 out << " fill=\""sv;
-                std::visit(OstreamColorPrinter{out}, *fill_color_);
+                std::visit(ColorPrinter{out}, *fill_color_);
                 out << "\""sv;
             }
             if (stroke_color_)
             {
                 out << " stroke=\""sv;
-                std::visit(OstreamColorPrinter{out}, *stroke_color_);
+                std::visit(ColorPrinter{out}, *stroke_color_);
                 out << "\""sv;
             }
             if (stroke_width_)
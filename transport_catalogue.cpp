@@ -1,132 +1,380 @@
 #include <algorithm>
+#include <numeric>
+#include <stdexcept>
 
 #include "transport_catalogue.h"
 
 namespace catalogue
 {
     using namespace domain;
-    void TransportCatalogue::AddStop(StopInputInfo stop_info)
+    using namespace std::string_literals;
+
+    TransportCatalogue::TransportCatalogue(const TransportCatalogue &other)
+        : stops_(other.stops_),
+          buses_(other.buses_),
+          buses_passing_stops_(other.buses_passing_stops_),
+          distance_between_stops_(other.distance_between_stops_),
+          bus_statistics_(other.bus_statistics_),
+          stop_buses_offsets_(other.stop_buses_offsets_),
+          stop_buses_(other.stop_buses_),
+          stop_buses_ready_(other.stop_buses_ready_)
     {
-        stops_[std::move(stop_info.name_stop)] = std::move(stop_info.coordinates);
+        // the name indexes refer to the names of this catalogue
+        for (const auto &[name, id] : other.stop_ids_)
+        {
+            stop_ids_.emplace(stops_[id].name, id);
+        }
+        for (const auto &[name, id] : other.bus_ids_)
+        {
+            bus_ids_.emplace(buses_[id].name, id);
+        }
+    }
+
+    TransportCatalogue &TransportCatalogue::operator=(const TransportCatalogue &other)
+    {
+        if (this != &other)
+        {
+            *this = TransportCatalogue(other);
+        }
+        return *this;
+    }
+
+    StopId TransportCatalogue::AddStop(StopInputInfo stop_info)
+    {
+        if (const auto id = FindStopId(stop_info.name_stop))
+        {
+            stops_[*id].coordinates = std::move(stop_info.coordinates);
+            ResetBusStatistics(*id);
+            return *id;
+        }
+        const StopId id = static_cast<StopId>(stops_.size());
+        stops_.push_back({std::move(stop_info.name_stop), std::move(stop_info.coordinates)});
+        stop_ids_[stops_.back().name] = id;
+        buses_passing_stops_.emplace_back();
+        stop_buses_ready_ = false;
+        return id;
     }
 
     void TransportCatalogue::AddDistanceBetweenStop(const StopInputInfo &stop_info)
     {
         if (!stop_info.distance_to_other_stops.empty())
         {
+            const StopId stop = stop_ids_.at(stop_info.name_stop);
             for (const auto &[other_stop, distance] : stop_info.distance_to_other_stops)
             {
-                distance_between_stops_[stops_.find(stop_info.name_stop)->first][stops_.find(other_stop)->first] = distance;
+                distance_between_stops_.Set(stop, stop_ids_.at(other_stop), distance);
             }
+            // every route with a segment between the stop and another one passes the stop
+            ResetBusStatistics(stop);
         }
     }
 
-    void TransportCatalogue::AddBus(const BusInputInfo &bus_info)
+    void TransportCatalogue::SetDistanceBetweenStops(StopId stop_from, StopId stop_to, int distance)
+    {
+        if (stop_from >= stops_.size() || stop_to >= stops_.size())
+        {
+            throw std::out_of_range("Unknown stop id");
+        }
+        distance_between_stops_.Set(stop_from, stop_to, distance);
+        ResetBusStatistics(stop_from);
+    }
+
+    void TransportCatalogue::RemoveDistanceBetweenStops(StopId stop_from, StopId stop_to)
+    {
+        if (stop_from >= stops_.size() || stop_to >= stops_.size())
+        {
+            throw std::out_of_range("Unknown stop id");
+        }
+        distance_between_stops_.Erase(stop_from, stop_to);
+        ResetBusStatistics(stop_from);
+    }
+
+    BusId TransportCatalogue::AddBus(const BusInputInfo &bus_info)
     {
         Bus bus;
+        bus.name = bus_info.name_bus;
         bus.is_circular = bus_info.is_circular;
         bus.stops.reserve(bus_info.stops.size());
         for (const std::string &stop : bus_info.stops)
         {
-            bus.stops.push_back({stops_.find(stop)->first, &stops_.find(stop)->second});
+            bus.stops.push_back(stop_ids_.at(stop));
         }
-        buses_[bus_info.name_bus] = std::move(bus);
-        for (const std::string &stop : bus_info.stops)
+        return AddBus(std::move(bus));
+    }
+
+    BusId TransportCatalogue::AddBus(Bus bus)
+    {
+        for (const StopId stop : bus.stops)
         {
-            buses_passing_stops_[stops_.find(stop)->first].insert(buses_.find(bus_info.name_bus)->first);
+            if (stop >= stops_.size())
+            {
+                throw std::out_of_range("Unknown stop id");
+            }
         }
+        BusId id = static_cast<BusId>(buses_.size());
+        if (const auto existing_id = FindBusId(bus.name))
+        {
+            id = *existing_id;
+            for (const StopId stop : buses_[id].stops)
+            {
+                std::vector<BusId> &buses = buses_passing_stops_[stop];
+                buses.erase(std::remove(buses.begin(), buses.end(), id), buses.end());
+            }
+            buses_[id] = std::move(bus);
+            bus_statistics_[id].reset();
+        }
+        else
+        {
+            buses_.push_back(std::move(bus));
+            bus_ids_[buses_.back().name] = id;
+            bus_statistics_.emplace_back();
+        }
+        for (const StopId stop : buses_[id].stops)
+        {
+            std::vector<BusId> &buses = buses_passing_stops_[stop];
+            if (std::find(buses.begin(), buses.end(), id) == buses.end())
+            {
+                buses.push_back(id);
+            }
+        }
+        stop_buses_ready_ = false;
+        return id;
+    }
+
+    void TransportCatalogue::RemoveStop(StopId id)
+    {
+        if (!buses_passing_stops_.at(id).empty())
+        {
+            throw std::invalid_argument("Buses pass the stop "s + stops_[id].name);
+        }
+        // the distances of the stop are dropped by OrderByName
+        stop_ids_.erase(stops_[id].name);
+        stop_buses_ready_ = false;
+    }
+
+    void TransportCatalogue::RemoveBus(BusId id)
+    {
+        Bus &bus = buses_.at(id);
+        for (const StopId stop : bus.stops)
+        {
+            std::vector<BusId> &buses = buses_passing_stops_[stop];
+            buses.erase(std::remove(buses.begin(), buses.end(), id), buses.end());
+        }
+        bus_ids_.erase(bus.name);
+        bus.stops.clear();
+        bus_statistics_[id].reset();
+        stop_buses_ready_ = false;
+    }
+
+    std::optional<StopId> TransportCatalogue::FindStopId(std::string_view name) const
+    {
+        const auto it = stop_ids_.find(name);
+        if (it == stop_ids_.end())
+        {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    std::optional<BusId> TransportCatalogue::FindBusId(std::string_view name) const
+    {
+        const auto it = bus_ids_.find(name);
+        if (it == bus_ids_.end())
+        {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    const Stop &TransportCatalogue::GetStop(StopId id) const
+    {
+        return stops_[id];
     }
 
-    BusInformation TransportCatalogue::FindBusInformation(const std::string &query) const
+    const Bus &TransportCatalogue::GetBus(BusId id) const
+    {
+        return buses_[id];
+    }
+
+    BusInformation TransportCatalogue::FindBusInformation(std::string_view query) const
     {
         BusInformation bus_information;
-        Bus bus;
-        if (buses_.count(query))
+        if (const auto id = FindBusId(query))
         {
-            bus = buses_.at(query);
-            bus_information.name_bus = buses_.find(query)->first;
-            std::tuple<int, int, double, double> info = CalculateBusInformation(bus);
-            bus_information.stops_on_route = std::get<0>(info);
-            bus_information.unique_stops = std::get<1>(info);
-            bus_information.route_length = std::get<2>(info);
-            bus_information.curvature = std::get<3>(info);
+            const BusStatistics &statistics = GetBusStatistics(*id);
+            bus_information.name_bus = buses_[*id].name;
+            bus_information.stops_on_route = statistics.stops_on_route;
+            bus_information.unique_stops = statistics.unique_stops;
+            bus_information.route_length = statistics.route_length;
+            bus_information.curvature = statistics.curvature;
         }
         return bus_information;
     }
 
-    StopInformation TransportCatalogue::FindStopInformation(const std::string &query) const
+    const BusStatistics &TransportCatalogue::GetBusStatistics(BusId id) const
+    {
+        const std::optional<BusStatistics> &statistics = bus_statistics_.at(id);
+        if (!statistics)
+        {
+            throw std::logic_error("Catalogue is not finalized"s);
+        }
+        return *statistics;
+    }
+
+    void TransportCatalogue::SetBusStatistics(BusId id, const BusStatistics &statistics)
+    {
+        bus_statistics_.at(id) = statistics;
+    }
+
+    StopInformation TransportCatalogue::FindStopInformation(std::string_view query) const
     {
         StopInformation stop_information;
-        if (stops_.count(query))
+        if (const auto id = FindStopId(query))
         {
-            if (buses_passing_stops_.count(query))
-            {
-                for (auto bus : buses_passing_stops_.at(query))
-                {
-                    stop_information.buses.insert(bus);
-                }
-            }
-            stop_information.name_stop = stops_.find(query)->first;
+            stop_information.name_stop = stops_[*id].name;
+            stop_information.buses = GetBusesPassingStop(*id);
         }
         return stop_information;
     }
 
-    std::map<std::string_view, const geo::Coordinates *> TransportCatalogue::FindAllWorkingStops() const
+    TransportCatalogue::BusesRange TransportCatalogue::GetBusesPassingStop(StopId id) const
     {
-        std::map<std::string_view, const geo::Coordinates *> stops;
-        for (const auto &[name_stop, coordinates] : stops_)
+        if (!stop_buses_ready_)
         {
-            if (!FindStopInformation(name_stop).buses.empty())
+            throw std::logic_error("Catalogue is not finalized"s);
+        }
+        return {stop_buses_.begin() + stop_buses_offsets_.at(id), stop_buses_.begin() + stop_buses_offsets_[id + 1]};
+    }
+
+    std::vector<StopId> TransportCatalogue::FindAllWorkingStops() const
+    {
+        std::vector<StopId> stops;
+        for (StopId id = 0; id < stops_.size(); ++id)
+        {
+            if (!buses_passing_stops_[id].empty())
             {
-                stops[name_stop] = &coordinates;
+                stops.push_back(id);
             }
         }
+        std::sort(stops.begin(), stops.end(), [this](StopId lhs, StopId rhs)
+                  { return stops_[lhs].name < stops_[rhs].name; });
         return stops;
     }
 
-    std::map<std::string_view, const Bus *> TransportCatalogue::FindAllWorkingBuses() const
+    std::vector<BusId> TransportCatalogue::FindAllWorkingBuses() const
     {
-        std::map<std::string_view, const Bus *> buses;
-        for (const auto &[name_bus, bus_info] : buses_)
+        std::vector<BusId> buses;
+        for (BusId id = 0; id < buses_.size(); ++id)
         {
-            if (!bus_info.stops.empty())
+            if (!buses_[id].stops.empty())
             {
-                buses[name_bus] = &bus_info;
+                buses.push_back(id);
             }
         }
+        std::sort(buses.begin(), buses.end(), [this](BusId lhs, BusId rhs)
+                  { return buses_[lhs].name < buses_[rhs].name; });
         return buses;
     }
 
-    const std::unordered_map<std::string_view, std::unordered_map<std::string_view, int>> &TransportCatalogue::GetDistanceBetweenStops() const
+    const DistanceTable &TransportCatalogue::GetDistanceBetweenStops() const
     {
         return distance_between_stops_;
     }
 
-    const std::unordered_map<std::string, Bus> &TransportCatalogue::GetAllBuses() const
+    const std::deque<Bus> &TransportCatalogue::GetAllBuses() const
     {
         return buses_;
     }
 
-    const std::unordered_map<std::string, geo::Coordinates> &TransportCatalogue::GetAllStops() const
+    const std::deque<Stop> &TransportCatalogue::GetAllStops() const
     {
         return stops_;
     }
 
-    std::tuple<int, int, double, double> TransportCatalogue::CalculateBusInformation(const Bus &bus) const
+    void TransportCatalogue::Finalize()
+    {
+        for (BusId id = 0; id < buses_.size(); ++id)
+        {
+            if (!bus_statistics_[id])
+            {
+                bus_statistics_[id] = CalculateBusStatistics(buses_[id]);
+            }
+        }
+        IndexStopBuses();
+    }
+
+    TransportCatalogue::Renumbering TransportCatalogue::OrderByName()
+    {
+        std::vector<StopId> stops;
+        for (StopId id = 0; id < stops_.size(); ++id)
+        {
+            if (FindStopId(stops_[id].name) == id)
+            {
+                stops.push_back(id);
+            }
+        }
+        std::sort(stops.begin(), stops.end(), [this](StopId lhs, StopId rhs)
+                  { return stops_[lhs].name < stops_[rhs].name; });
+        std::vector<BusId> buses;
+        for (BusId id = 0; id < buses_.size(); ++id)
+        {
+            if (FindBusId(buses_[id].name) == id)
+            {
+                buses.push_back(id);
+            }
+        }
+        std::sort(buses.begin(), buses.end(), [this](BusId lhs, BusId rhs)
+                  { return buses_[lhs].name < buses_[rhs].name; });
+        Renumbering renumbering{std::vector<StopId>(stops_.size(), Renumbering::REMOVED), std::vector<BusId>(buses_.size(), Renumbering::REMOVED)};
+        for (StopId id = 0; id < stops.size(); ++id)
+        {
+            renumbering.stops[stops[id]] = id;
+        }
+        for (BusId id = 0; id < buses.size(); ++id)
+        {
+            renumbering.buses[buses[id]] = id;
+        }
+
+        TransportCatalogue ordered;
+        for (const StopId stop : stops)
+        {
+            ordered.AddStop({std::move(stops_[stop].name), stops_[stop].coordinates, {}});
+        }
+        distance_between_stops_.ForEach([&ordered, &renumbering](StopId stop_from, StopId stop_to, int distance)
+                                        {
+                                            if (renumbering.stops[stop_from] != Renumbering::REMOVED && renumbering.stops[stop_to] != Renumbering::REMOVED)
+                                            {
+                                                ordered.distance_between_stops_.Set(renumbering.stops[stop_from], renumbering.stops[stop_to], distance);
+                                            }
+                                        });
+        for (const BusId bus : buses)
+        {
+            for (StopId &stop : buses_[bus].stops)
+            {
+                stop = renumbering.stops[stop];
+            }
+            const BusId id = ordered.AddBus(std::move(buses_[bus]));
+            ordered.bus_statistics_[id] = bus_statistics_[bus];
+        }
+        *this = std::move(ordered);
+        return renumbering;
+    }
+
+    BusStatistics TransportCatalogue::CalculateBusStatistics(const Bus &bus) const
     {
-        std::unordered_set<std::string_view> unique_stops;
         int stops_on_route = 0;
         double straight_route_length = 0;
         double real_route_length = 0;
+        std::vector<StopId> unique_stops = bus.stops;
+        std::sort(unique_stops.begin(), unique_stops.end());
+        unique_stops.erase(std::unique(unique_stops.begin(), unique_stops.end()), unique_stops.end());
         if (bus.stops.size() != 0)
         {
             for (size_t i = 0; i < bus.stops.size() - 1; ++i)
             {
-                unique_stops.insert(bus.stops[i].first);
-                straight_route_length += ComputeDistance(*bus.stops[i].second, *bus.stops[i + 1].second);
+                straight_route_length += ComputeDistance(stops_[bus.stops[i]].coordinates, stops_[bus.stops[i + 1]].coordinates);
                 real_route_length += CalculateDistance(bus.stops[i], bus.stops[i + 1]);
             }
-            unique_stops.insert(bus.stops.back().first);
             stops_on_route = bus.stops.size();
             if (!bus.is_circular)
             {
@@ -138,25 +386,52 @@ namespace catalogue
                 }
             }
         }
-        return {stops_on_route, unique_stops.size(), real_route_length, real_route_length / straight_route_length};
+        return {stops_on_route, static_cast<int>(unique_stops.size()), static_cast<int>(real_route_length), real_route_length / straight_route_length};
     }
 
-    double TransportCatalogue::CalculateDistance(const std::pair<std::string_view, const geo::Coordinates *> stop_from,
-                                                 const std::pair<std::string_view, const geo::Coordinates *> stop_to) const
+    void TransportCatalogue::IndexStopBuses()
     {
-        double route_length = 0;
-        if (distance_between_stops_.count(stop_from.first) && distance_between_stops_.at(stop_from.first).count(stop_to.first))
+        stop_buses_offsets_.assign(stops_.size() + 1, 0);
+        for (StopId stop = 0; stop < stops_.size(); ++stop)
         {
-            route_length += distance_between_stops_.at(stop_from.first).at(stop_to.first);
+            stop_buses_offsets_[stop + 1] = stop_buses_offsets_[stop] + buses_passing_stops_[stop].size();
         }
-        else if (distance_between_stops_.count(stop_to.first) && distance_between_stops_.at(stop_to.first).count(stop_from.first))
+        stop_buses_.resize(stop_buses_offsets_.back());
+
+        // the buses are placed in the order of their names, so the buses of every stop come out sorted
+        std::vector<BusId> buses(buses_.size());
+        std::iota(buses.begin(), buses.end(), 0);
+        std::sort(buses.begin(), buses.end(), [this](BusId lhs, BusId rhs)
+                  { return buses_[lhs].name < buses_[rhs].name; });
+        std::vector<uint32_t> positions(stop_buses_offsets_.begin(), stop_buses_offsets_.end() - 1);
+        for (const BusId bus : buses)
         {
-            route_length += distance_between_stops_.at(stop_to.first).at(stop_from.first);
+            for (const StopId stop : buses_[bus].stops)
+            {
+                // a stop visited twice by the bus already has it as its last bus
+                if (positions[stop] == stop_buses_offsets_[stop] || stop_buses_[positions[stop] - 1] != bus)
+                {
+                    stop_buses_[positions[stop]++] = bus;
+                }
+            }
         }
-        else
+        stop_buses_ready_ = true;
+    }
+
+    void TransportCatalogue::ResetBusStatistics(StopId stop)
+    {
+        for (const BusId bus : buses_passing_stops_[stop])
+        {
+            bus_statistics_[bus].reset();
+        }
+    }
+
+    double TransportCatalogue::CalculateDistance(StopId stop_from, StopId stop_to) const
+    {
+        if (const auto distance = distance_between_stops_.Find(stop_from, stop_to))
         {
-            route_length = ComputeDistance(*stop_from.second, *stop_to.second);
+            return *distance;
         }
-        return route_length;
+        return ComputeDistance(stops_[stop_from].coordinates, stops_[stop_to].coordinates);
     }
-}
\ No newline at end of file
+}
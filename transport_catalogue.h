@@ -1,46 +1,125 @@
 #pragma once
 
-#include <unordered_set>
-#include <tuple>
+#include <deque>
+#include <limits>
+#include <optional>
 #include <map>
 
 #include "domain.h"
+#include "distance_table.h"
 
 namespace catalogue
 {
     using namespace domain;
+    // Stops and buses are kept in the order of their ids, names are resolved to ids only by FindStopId and FindBusId
     class TransportCatalogue
     {
     public:
-        void AddStop(StopInputInfo stop_info);
+        using BusesRange = ranges::Range<std::vector<BusId>::const_iterator>;
+
+        // Old id -> new id of every stop and bus, REMOVED for the ones which have been removed
+        struct Renumbering
+        {
+            static constexpr uint32_t REMOVED = std::numeric_limits<uint32_t>::max();
+
+            std::vector<StopId> stops;
+            std::vector<BusId> buses;
+        };
+
+        TransportCatalogue() = default;
+
+        TransportCatalogue(const TransportCatalogue &other);
+
+        TransportCatalogue(TransportCatalogue &&) = default;
+
+        TransportCatalogue &operator=(const TransportCatalogue &other);
+
+        TransportCatalogue &operator=(TransportCatalogue &&) = default;
+
+        StopId AddStop(StopInputInfo stop_info);
 
         void AddDistanceBetweenStop(const StopInputInfo &stop_info);
 
-        void AddBus(const BusInputInfo &bus_info);
+        void SetDistanceBetweenStops(StopId stop_from, StopId stop_to, int distance);
+
+        void RemoveDistanceBetweenStops(StopId stop_from, StopId stop_to);
+
+        BusId AddBus(const BusInputInfo &bus_info);
+
+        // The stops of the bus have to be added before
+        BusId AddBus(Bus bus);
+
+        // Removed stops and buses are no longer found by name, their ids stay taken until OrderByName.
+        // No bus may pass a removed stop
+        void RemoveStop(StopId id);
 
-        BusInformation FindBusInformation(const std::string &query) const;
+        void RemoveBus(BusId id);
 
-        StopInformation FindStopInformation(const std::string &query) const;
+        std::optional<StopId> FindStopId(std::string_view name) const;
 
-        std::map<std::string_view, const geo::Coordinates *> FindAllWorkingStops() const;
+        std::optional<BusId> FindBusId(std::string_view name) const;
 
-        std::map<std::string_view, const Bus *> FindAllWorkingBuses() const;
+        const Stop &GetStop(StopId id) const;
 
-        const std::unordered_map<std::string_view, std::unordered_map<std::string_view, int>> &GetDistanceBetweenStops() const;
+        const Bus &GetBus(BusId id) const;
 
-        const std::unordered_map<std::string, Bus> &GetAllBuses() const;
+        BusInformation FindBusInformation(std::string_view query) const;
 
-        const std::unordered_map<std::string, geo::Coordinates> &GetAllStops() const;
+        // Computed by Finalize, out of date after the bus, its stops or their distances have changed
+        const BusStatistics &GetBusStatistics(BusId id) const;
 
-        double CalculateDistance(const std::pair<std::string_view, const geo::Coordinates *> stop_from,
-                                 const std::pair<std::string_view, const geo::Coordinates *> stop_to) const;
+        // For statistics loaded together with the bus: the bus and its distances have to be added before
+        void SetBusStatistics(BusId id, const BusStatistics &statistics);
+
+        StopInformation FindStopInformation(std::string_view query) const;
+
+        // Sorted by name, indexed by Finalize
+        BusesRange GetBusesPassingStop(StopId id) const;
+
+        // Stops which some bus passes, sorted by name
+        std::vector<StopId> FindAllWorkingStops() const;
+
+        // Buses with at least one stop, sorted by name
+        std::vector<BusId> FindAllWorkingBuses() const;
+
+        const DistanceTable &GetDistanceBetweenStops() const;
+
+        // Indexed by id
+        const std::deque<Bus> &GetAllBuses() const;
+
+        // Indexed by id
+        const std::deque<Stop> &GetAllStops() const;
+
+        double CalculateDistance(StopId stop_from, StopId stop_to) const;
+
+        // Computes what the catalogue answers from once it is loaded or patched: the statistics of the buses which do not
+        // have them and the stop -> buses index. The getters only read, so a finalized catalogue may be queried from several threads
+        void Finalize();
+
+        // Renumbers the stops and the buses in the order of their names, so the ids do not depend on the order
+        // they have been added in, and drops the removed ones. Computed statistics are kept
+        Renumbering OrderByName();
 
     private:
-        std::unordered_map<std::string, Bus> buses_;
-        std::unordered_map<std::string, geo::Coordinates> stops_;
-        std::unordered_map<std::string_view, std::unordered_set<std::string_view>> buses_passing_stops_;
-        std::unordered_map<std::string_view, std::unordered_map<std::string_view, int>> distance_between_stops_;
+        // deque: the names stay in place, the name indexes refer to them
+        std::deque<Stop> stops_;
+        std::deque<Bus> buses_;
+        std::unordered_map<std::string_view, StopId> stop_ids_;
+        std::unordered_map<std::string_view, BusId> bus_ids_;
+        std::vector<std::vector<BusId>> buses_passing_stops_;
+        DistanceTable distance_between_stops_;
+        // indexed by bus id, empty while the statistics are out of date
+        std::vector<std::optional<BusStatistics>> bus_statistics_;
+        // stop -> buses in one array: the buses of a stop begin at its offset and are sorted by name.
+        // Built by Finalize, out of date after a stop or a bus has been added or removed
+        std::vector<uint32_t> stop_buses_offsets_;
+        std::vector<BusId> stop_buses_;
+        bool stop_buses_ready_ = false;
+
+        BusStatistics CalculateBusStatistics(const Bus &bus) const;
+
+        void ResetBusStatistics(StopId stop);
 
-        std::tuple<int, int, double, double> CalculateBusInformation(const Bus &bus) const;
+        void IndexStopBuses();
     };
-}
\ No newline at end of file
+}
@@ -1,4 +1,9 @@
 #include "transport_router.h"
+#include "dijkstra_router.h"
+#include "contraction_hierarchy.h"
+
+#include <algorithm>
+#include <tuple>
 
 using namespace std::string_literals;
 
@@ -9,7 +14,10 @@ namespace catalogue::tr_router
     TransoprtRouter::TransoprtRouter(const catalogue::TransportCatalogue &transport_catalogue, const json::Node &routing_settings)
         : transport_catalogue_(transport_catalogue),
           bus_velocity_(routing_settings.AsDict().at("bus_velocity"s).AsDouble()),
-          bus_wait_time_(routing_settings.AsDict().at("bus_wait_time"s).AsDouble())
+          bus_wait_time_(routing_settings.AsDict().at("bus_wait_time"s).AsDouble()),
+          router_type_(ReadRouterType(routing_settings.AsDict())),
+          routes_table_settings_(ReadRoutesTableSettings(routing_settings.AsDict())),
+          graph_model_(ReadGraphModel(routing_settings.AsDict()))
     {
         SetStopsId();
     }
@@ -22,78 +30,334 @@ namespace catalogue::tr_router
 
     Graph TransoprtRouter::CreateGraph()
     {
-        Graph graph(stops_id_.size());
-        std::map<std::string_view, const domain::Bus *> buses = transport_catalogue_.FindAllWorkingBuses();
-        for (const auto &bus : buses)
+        const std::vector<domain::BusId> buses = transport_catalogue_.FindAllWorkingBuses();
+        Graph graph(CountVertices(buses));
+        size_t next_vertex = working_stops_count_;
+        for (const domain::BusId bus_id : buses)
         {
-            for (size_t i = 0; i + 1 < bus.second->stops.size(); ++i)
+            AddBusEdges(graph, next_vertex, bus_id);
+            next_vertex += CountRideVertices(transport_catalogue_.GetBus(bus_id));
+        }
+        return graph;
+    }
+
+    Graph TransoprtRouter::UpdateGraph(const TransoprtRouter &previous, const FrozenGraph &previous_graph,
+                                       const TransportCatalogue::Renumbering &renumbering, const domain::CatalogueChanges &changes,
+                                       graph::GraphUpdate &update)
+    {
+        constexpr uint32_t REMOVED = TransportCatalogue::Renumbering::REMOVED;
+        const TransportCatalogue &previous_catalogue = previous.GetTransoprtCatalogue();
+        const size_t previous_bus_count = previous_catalogue.GetAllBuses().size();
+
+        // a bus is generated again when it has changed or one of its stops has
+        std::vector<bool> is_changed(transport_catalogue_.GetAllBuses().size());
+        for (const domain::StopId stop : changes.stops)
+        {
+            if (renumbering.stops.at(stop) != REMOVED)
             {
-                double weight = bus_wait_time_;
-                for (size_t j = i + 1; j < bus.second->stops.size(); ++j)
+                for (const domain::BusId bus : transport_catalogue_.GetBusesPassingStop(renumbering.stops[stop]))
                 {
-                    if (bus.second->stops[i].first == bus.second->stops[j].first)
+                    is_changed[bus] = true;
+                }
+            }
+        }
+        for (const domain::BusId bus : changes.buses)
+        {
+            if (renumbering.buses.at(bus) != REMOVED)
+            {
+                is_changed[renumbering.buses[bus]] = true;
+            }
+        }
+        std::vector<domain::BusId> previous_buses(transport_catalogue_.GetAllBuses().size(), REMOVED);
+        for (domain::BusId bus = 0; bus < previous_bus_count; ++bus)
+        {
+            if (renumbering.buses[bus] != REMOVED)
+            {
+                previous_buses[renumbering.buses[bus]] = bus;
+            }
+        }
+
+        // the edges of a bus are in a row, its ride vertices as well
+        std::vector<size_t> first_edges(previous_bus_count, 0);
+        std::vector<size_t> edge_counts(previous_bus_count, 0);
+        for (size_t edge_id = previous.GetEdgeCount(); edge_id-- > 0;)
+        {
+            const domain::BusId bus = previous.GetEdgeRecord(edge_id).bus;
+            first_edges[bus] = edge_id;
+            ++edge_counts[bus];
+        }
+        std::vector<size_t> first_ride_vertices(previous_bus_count, 0);
+        size_t next_vertex = previous.working_stops_count_;
+        for (const domain::BusId bus : previous_catalogue.FindAllWorkingBuses())
+        {
+            first_ride_vertices[bus] = next_vertex;
+            next_vertex += CountRideVertices(previous_catalogue.GetBus(bus));
+        }
+
+        update.vertices.assign(previous_graph.GetVertexCount(), graph::GraphUpdate::REMOVED);
+        update.edges.assign(previous_graph.GetEdgeCount(), graph::GraphUpdate::REMOVED);
+        for (domain::StopId stop = 0; stop < previous.stops_vertex_.size(); ++stop)
+        {
+            if (previous.stops_vertex_[stop] != NO_VERTEX && renumbering.stops[stop] != REMOVED &&
+                stops_vertex_[renumbering.stops[stop]] != NO_VERTEX)
+            {
+                update.vertices[previous.stops_vertex_[stop]] = stops_vertex_[renumbering.stops[stop]];
+            }
+        }
+
+        const std::vector<domain::BusId> buses = transport_catalogue_.FindAllWorkingBuses();
+        Graph graph(CountVertices(buses));
+        edges_.clear();
+        next_vertex = working_stops_count_;
+        for (const domain::BusId bus_id : buses)
+        {
+            const domain::Bus &bus = transport_catalogue_.GetBus(bus_id);
+            const domain::BusId previous_bus = previous_buses[bus_id];
+            if (is_changed[bus_id] || previous_bus == REMOVED)
+            {
+                const size_t first_edge = graph.GetEdgeCount();
+                AddBusEdges(graph, next_vertex, bus_id);
+                if (previous_bus != REMOVED)
+                {
+                    // a bus changed only by the distances between its stops keeps its ride vertices
+                    if (IsSameRoute(previous_catalogue.GetBus(previous_bus), bus, renumbering))
                     {
-                        double weight = bus_wait_time_;
-                        for (size_t k = j + 1; k < bus.second->stops.size(); ++k)
+                        for (size_t vertex = 0; vertex < CountRideVertices(bus); ++vertex)
                         {
-                            graph::Edge<double> edge = CreateEdge(weight, bus, i, k, true);
-                            domain::EdgeInfo edge_info = CountEdgeInfo(weight, bus, i, k);
-                            edge_info.span_count = k - j;
-                            edges_info_[graph.AddEdge(edge)] = edge_info;
+                            update.vertices[first_ride_vertices[previous_bus] + vertex] = next_vertex + vertex;
                         }
                     }
-                    graph::Edge<double> edge = CreateEdge(weight, bus, i, j, true);
-                    domain::EdgeInfo edge_info = CountEdgeInfo(weight, bus, i, j);
-                    edge_info.span_count = j - i;
-                    edges_info_[graph.AddEdge(edge)] = edge_info;
+                    KeepSameEdges(previous, previous_graph, first_edges[previous_bus], edge_counts[previous_bus], graph, first_edge, update);
+                }
+                next_vertex += CountRideVertices(bus);
+                continue;
+            }
+            // the same route over the same stops: the edges are taken as they are, only the ids change
+            for (size_t vertex = 0; vertex < CountRideVertices(bus); ++vertex)
+            {
+                update.vertices[first_ride_vertices[previous_bus] + vertex] = next_vertex + vertex;
+            }
+            next_vertex += CountRideVertices(bus);
+            for (size_t edge_id = first_edges[previous_bus]; edge_id < first_edges[previous_bus] + edge_counts[previous_bus]; ++edge_id)
+            {
+                const graph::Edge<double> &edge = previous_graph.GetEdge(edge_id);
+                domain::EdgeRecord record = previous.GetEdgeRecord(edge_id);
+                record.bus = bus_id;
+                record.stop_from = renumbering.stops[record.stop_from];
+                record.stop_to = renumbering.stops[record.stop_to];
+                update.edges[edge_id] = graph.GetEdgeCount();
+                AddEdge(graph, {update.vertices[edge.from], update.vertices[edge.to], edge.weight}, record);
+            }
+        }
+        return graph;
+    }
+
+    bool TransoprtRouter::IsSameRoute(const domain::Bus &previous_bus, const domain::Bus &bus, const TransportCatalogue::Renumbering &renumbering)
+    {
+        return previous_bus.is_circular == bus.is_circular && previous_bus.stops.size() == bus.stops.size() &&
+               std::equal(previous_bus.stops.begin(), previous_bus.stops.end(), bus.stops.begin(), [&renumbering](domain::StopId previous_stop, domain::StopId stop)
+                          { return renumbering.stops[previous_stop] == stop; });
+    }
+
+    void TransoprtRouter::KeepSameEdges(const TransoprtRouter &previous, const FrozenGraph &previous_graph, size_t first_previous_edge,
+                                        size_t previous_edge_count, const Graph &graph, size_t first_edge, graph::GraphUpdate &update) const
+    {
+        using EdgeKey = std::tuple<size_t, size_t, uint32_t, double>;
+        std::vector<std::pair<EdgeKey, size_t>> previous_edges;
+        previous_edges.reserve(previous_edge_count);
+        for (size_t edge_id = first_previous_edge; edge_id < first_previous_edge + previous_edge_count; ++edge_id)
+        {
+            const graph::Edge<double> edge = previous_graph.GetEdge(edge_id);
+            const domain::EdgeRecord &record = previous.GetEdgeRecord(edge_id);
+            if (update.vertices[edge.from] != graph::GraphUpdate::REMOVED && update.vertices[edge.to] != graph::GraphUpdate::REMOVED)
+            {
+                previous_edges.push_back({{update.vertices[edge.from], update.vertices[edge.to], record.span_count, record.time}, edge_id});
+            }
+        }
+        std::sort(previous_edges.begin(), previous_edges.end());
+        std::vector<bool> is_taken(previous_edges.size());
+        for (size_t edge_id = first_edge; edge_id < graph.GetEdgeCount(); ++edge_id)
+        {
+            const graph::Edge<double> &edge = graph.GetEdge(edge_id);
+            const EdgeKey key{edge.from, edge.to, edges_[edge_id].span_count, edges_[edge_id].time};
+            auto it = std::lower_bound(previous_edges.begin(), previous_edges.end(), std::pair{key, size_t{0}});
+            for (; it != previous_edges.end() && it->first == key; ++it)
+            {
+                if (!is_taken[it - previous_edges.begin()])
+                {
+                    is_taken[it - previous_edges.begin()] = true;
+                    update.edges[it->second] = edge_id;
+                    break;
                 }
             }
-            if (!bus.second->is_circular)
+        }
+    }
+
+    void TransoprtRouter::AddBusEdges(Graph &graph, size_t first_ride_vertex, domain::BusId bus_id)
+    {
+        const domain::Bus &bus = transport_catalogue_.GetBus(bus_id);
+        if (graph_model_ == GraphModel::RIDE_SEGMENTS)
+        {
+            AddRideSegments(graph, first_ride_vertex, bus_id, bus.stops);
+            if (!bus.is_circular)
             {
-                for (size_t i = bus.second->stops.size() - 1; i > 0; --i)
+                AddRideSegments(graph, first_ride_vertex + bus.stops.size(), bus_id, {bus.stops.rbegin(), bus.stops.rend()});
+            }
+            return;
+        }
+        for (size_t i = 0; i + 1 < bus.stops.size(); ++i)
+        {
+            double weight = bus_wait_time_;
+            for (size_t j = i + 1; j < bus.stops.size(); ++j)
+            {
+                if (bus.stops[i] == bus.stops[j])
                 {
                     double weight = bus_wait_time_;
-                    for (size_t j = i - 1; j + 1 > 0; --j)
+                    for (size_t k = j + 1; k < bus.stops.size(); ++k)
+                    {
+                        graph::Edge<double> edge = CreateEdge(weight, bus, i, k, true);
+                        domain::EdgeRecord record = CountEdgeRecord(weight, bus_id, i, k);
+                        record.span_count = k - j;
+                        AddEdge(graph, edge, record);
+                    }
+                }
+                graph::Edge<double> edge = CreateEdge(weight, bus, i, j, true);
+                domain::EdgeRecord record = CountEdgeRecord(weight, bus_id, i, j);
+                record.span_count = j - i;
+                AddEdge(graph, edge, record);
+            }
+        }
+        if (!bus.is_circular)
+        {
+            for (size_t i = bus.stops.size() - 1; i > 0; --i)
+            {
+                double weight = bus_wait_time_;
+                for (size_t j = i - 1; j + 1 > 0; --j)
+                {
+                    if (bus.stops[i] == bus.stops[j])
                     {
-                        if (bus.second->stops[i].first == bus.second->stops[j].first)
+                        double weight = bus_wait_time_;
+                        for (size_t k = j - 1; k + 1 > 0; --k)
                         {
-                            double weight = bus_wait_time_;
-                            for (size_t k = j - 1; k + 1 > 0; --k)
-                            {
-                                graph::Edge<double> edge = CreateEdge(weight, bus, i, k, false);
-                                domain::EdgeInfo edge_info = CountEdgeInfo(weight, bus, i, k);
-                                edge_info.span_count = j - k;
-                                edges_info_[graph.AddEdge(edge)] = edge_info;
-                            }
+                            graph::Edge<double> edge = CreateEdge(weight, bus, i, k, false);
+                            domain::EdgeRecord record = CountEdgeRecord(weight, bus_id, i, k);
+                            record.span_count = j - k;
+                            AddEdge(graph, edge, record);
                         }
-                        graph::Edge<double> edge = CreateEdge(weight, bus, i, j, false);
-                        domain::EdgeInfo edge_info = CountEdgeInfo(weight, bus, i, j);
-                        edge_info.span_count = i - j;
-                        edges_info_[graph.AddEdge(edge)] = edge_info;
                     }
+                    graph::Edge<double> edge = CreateEdge(weight, bus, i, j, false);
+                    domain::EdgeRecord record = CountEdgeRecord(weight, bus_id, i, j);
+                    record.span_count = i - j;
+                    AddEdge(graph, edge, record);
                 }
             }
         }
-        return graph;
+    }
+
+    size_t TransoprtRouter::CountVertices(const std::vector<domain::BusId> &buses) const
+    {
+        size_t vertex_count = working_stops_count_;
+        for (const domain::BusId bus : buses)
+        {
+            vertex_count += CountRideVertices(transport_catalogue_.GetBus(bus));
+        }
+        return vertex_count;
+    }
+
+    size_t TransoprtRouter::CountRideVertices(const domain::Bus &bus) const
+    {
+        if (graph_model_ == GraphModel::STOP_PAIRS)
+        {
+            return 0;
+        }
+        return bus.is_circular ? bus.stops.size() : bus.stops.size() * 2;
+    }
+
+    std::unique_ptr<graph::RouterBase<double>> TransoprtRouter::CreateRouter(const graph::CsrGraph<double> &graph) const
+    {
+        if (router_type_ == RouterType::DIJKSTRA)
+        {
+            return std::make_unique<graph::DijkstraRouter<double>>(graph);
+        }
+        else if (router_type_ == RouterType::CONTRACTION_HIERARCHIES)
+        {
+            return std::make_unique<graph::ContractionHierarchy<double>>(graph);
+        }
+        return std::make_unique<graph::Router<double>>(graph, routes_table_settings_);
+    }
+
+    std::unique_ptr<graph::RouterBase<double>> TransoprtRouter::UpdateRouter(const FrozenGraph &graph, const Router &previous_router,
+                                                                           const graph::GraphUpdate &update) const
+    {
+        if (const auto *routes_table = dynamic_cast<const graph::Router<double> *>(&previous_router))
+        {
+            return std::make_unique<graph::Router<double>>(graph, routes_table->GetRoutesTable(), update);
+        }
+        // the hierarchy is contracted again, the Dijkstra router has nothing to keep
+        return CreateRouter(graph);
     }
 
     bool TransoprtRouter::StopIsWorking(std::string_view name_stop) const
     {
-        return stops_id_.count(name_stop);
+        const auto stop = transport_catalogue_.FindStopId(name_stop);
+        return stop && stops_vertex_[*stop] != NO_VERTEX;
     }
 
     size_t TransoprtRouter::GetStopId(std::string_view name_stop) const
     {
-        return stops_id_.at(name_stop);
+        const auto stop = transport_catalogue_.FindStopId(name_stop);
+        if (!stop)
+        {
+            throw std::out_of_range("Unknown stop: "s + std::string(name_stop));
+        }
+        return GetVertexId(*stop);
+    }
+
+    size_t TransoprtRouter::GetVertexId(domain::StopId stop) const
+    {
+        if (stops_vertex_.at(stop) == NO_VERTEX)
+        {
+            throw std::out_of_range("No bus passes the stop "s + transport_catalogue_.GetStop(stop).name);
+        }
+        return stops_vertex_[stop];
     }
 
-    domain::EdgeInfo TransoprtRouter::GetEdgeInfo(double edge) const
+    size_t TransoprtRouter::GetStopsCount() const
     {
-        return edges_info_.at(edge);
+        return working_stops_count_;
     }
 
-    domain::RouteInformation TransoprtRouter::FindRouteInformation(const std::optional<graph::Router<double>::RouteInfo> &route) const
+    domain::EdgeInfo TransoprtRouter::GetEdgeInfo(size_t edge) const
     {
+        const domain::EdgeRecord &record = GetEdgeRecord(edge);
+        return {transport_catalogue_.GetBus(record.bus).name, static_cast<int>(record.span_count), record.time,
+                transport_catalogue_.GetStop(record.stop_from).name, transport_catalogue_.GetStop(record.stop_to).name};
+    }
+
+    const domain::EdgeRecord &TransoprtRouter::GetEdgeRecord(size_t edge) const
+    {
+        if (mapped_edges_)
+        {
+            if (edge >= mapped_edge_count_)
+            {
+                throw std::out_of_range("Edge is out of range"s);
+            }
+            return mapped_edges_[edge];
+        }
+        return edges_.at(edge);
+    }
+
+    size_t TransoprtRouter::GetEdgeCount() const
+    {
+        return mapped_edges_ ? mapped_edge_count_ : edges_.size();
+    }
+
+    domain::RouteInformation TransoprtRouter::FindRouteInformation(const std::optional<Router::RouteInfo> &route) const
+    {
+        if (route.has_value() && graph_model_ == GraphModel::RIDE_SEGMENTS)
+        {
+            return FoldRideSegments(*route);
+        }
         domain::RouteInformation route_info;
         if (route.has_value())
         {
@@ -108,19 +372,43 @@ namespace catalogue::tr_router
         return route_info;
     }
 
-    const std::unordered_map<size_t, domain::EdgeInfo> &TransoprtRouter::GetEdgesInfo() const
+    double TransoprtRouter::GetBusWaitTime() const
     {
-        return edges_info_;
+        return bus_wait_time_;
     }
 
-    double TransoprtRouter::GetBusWaitTime() const
+    double TransoprtRouter::GetBusVelocity() const
     {
-        return bus_wait_time_;
+        return bus_velocity_;
+    }
+
+    RouterType TransoprtRouter::GetRouterType() const
+    {
+        return router_type_;
+    }
+
+    const graph::RoutesTableSettings &TransoprtRouter::GetRoutesTableSettings() const
+    {
+        return routes_table_settings_;
+    }
+
+    GraphModel TransoprtRouter::GetGraphModel() const
+    {
+        return graph_model_;
+    }
+
+    void TransoprtRouter::SetEdgeRecords(std::vector<domain::EdgeRecord> edges)
+    {
+        edges_ = std::move(edges);
+        mapped_edges_ = nullptr;
+        mapped_edge_count_ = 0;
     }
 
-    void TransoprtRouter::AddEdgeInfo(size_t id, const domain::EdgeInfo &edge_info)
+    void TransoprtRouter::SetEdgeRecords(const domain::EdgeRecord *edges, size_t count)
     {
-        edges_info_[id] = edge_info;
+        edges_.clear();
+        mapped_edges_ = edges;
+        mapped_edge_count_ = count;
     }
 
     void TransoprtRouter::SetBusWaitTime(double bus_wait_time)
@@ -133,6 +421,16 @@ namespace catalogue::tr_router
         bus_velocity_ = bus_velocity;
     }
 
+    void TransoprtRouter::SetRouterType(RouterType router_type)
+    {
+        router_type_ = router_type;
+    }
+
+    void TransoprtRouter::SetGraphModel(GraphModel graph_model)
+    {
+        graph_model_ = graph_model;
+    }
+
     const catalogue::TransportCatalogue &TransoprtRouter::GetTransoprtCatalogue() const
     {
         return transport_catalogue_;
@@ -140,39 +438,157 @@ namespace catalogue::tr_router
 
     void TransoprtRouter::SetStopsId()
     {
-        std::map<std::string_view, const geo::Coordinates *> all_working_stops = transport_catalogue_.FindAllWorkingStops();
-        for (const auto &[stop, _] : all_working_stops)
+        stops_vertex_.assign(transport_catalogue_.GetAllStops().size(), NO_VERTEX);
+        for (const domain::StopId stop : transport_catalogue_.FindAllWorkingStops())
+        {
+            stops_vertex_[stop] = working_stops_count_++;
+        }
+    }
+
+    RouterType TransoprtRouter::ReadRouterType(const json::Dict &routing_settings)
+    {
+        if (!routing_settings.count("router"s))
         {
-            stops_id_[stop] = stops_id_.size();
+            return RouterType::ALL_PAIRS;
         }
+        const std::string &router = routing_settings.at("router"s).AsString();
+        if (router == "all_pairs"s)
+        {
+            return RouterType::ALL_PAIRS;
+        }
+        else if (router == "dijkstra"s)
+        {
+            return RouterType::DIJKSTRA;
+        }
+        else if (router == "contraction_hierarchies"s)
+        {
+            return RouterType::CONTRACTION_HIERARCHIES;
+        }
+        throw std::invalid_argument("Unknown router type: "s + router);
+    }
+
+    GraphModel TransoprtRouter::ReadGraphModel(const json::Dict &routing_settings)
+    {
+        if (!routing_settings.count("graph_model"s))
+        {
+            return GraphModel::STOP_PAIRS;
+        }
+        const std::string &graph_model = routing_settings.at("graph_model"s).AsString();
+        if (graph_model == "stop_pairs"s)
+        {
+            return GraphModel::STOP_PAIRS;
+        }
+        else if (graph_model == "ride_segments"s)
+        {
+            return GraphModel::RIDE_SEGMENTS;
+        }
+        throw std::invalid_argument("Unknown graph model: "s + graph_model);
+    }
+
+    graph::RoutesTableSettings TransoprtRouter::ReadRoutesTableSettings(const json::Dict &routing_settings)
+    {
+        graph::RoutesTableSettings settings;
+        if (routing_settings.count("router_threads"s))
+        {
+            const int thread_count = routing_settings.at("router_threads"s).AsInt();
+            if (thread_count < 0)
+            {
+                throw std::invalid_argument("Negative router_threads"s);
+            }
+            // 0 - one thread per hardware core
+            settings.thread_count = thread_count == 0 ? std::max(1u, std::thread::hardware_concurrency()) : thread_count;
+        }
+        if (routing_settings.count("router_tile_size"s))
+        {
+            const int tile_size = routing_settings.at("router_tile_size"s).AsInt();
+            if (tile_size < 0)
+            {
+                throw std::invalid_argument("Negative router_tile_size"s);
+            }
+            settings.tile_size = tile_size;
+        }
+        return settings;
+    }
+
+    void TransoprtRouter::AddRideSegments(Graph &graph, size_t first_vertex, domain::BusId bus, const std::vector<domain::StopId> &stops)
+    {
+        for (size_t i = 0; i < stops.size(); ++i)
+        {
+            const size_t stop_vertex = stops_vertex_[stops[i]];
+            const size_t ride_vertex = first_vertex + i;
+            if (i + 1 < stops.size())
+            {
+                AddEdge(graph, {stop_vertex, ride_vertex, bus_wait_time_}, {bus, stops[i], stops[i], 0, 0});
+                const double time = (transport_catalogue_.CalculateDistance(stops[i], stops[i + 1]) * 1.0) / (bus_velocity_ / 0.06);
+                AddEdge(graph, {ride_vertex, ride_vertex + 1, time}, {bus, stops[i], stops[i + 1], 1, time});
+            }
+            if (i > 0)
+            {
+                AddEdge(graph, {ride_vertex, stop_vertex, 0}, {bus, stops[i], stops[i], 0, 0});
+            }
+        }
+    }
+
+    void TransoprtRouter::AddEdge(Graph &graph, const graph::Edge<double> &edge, const domain::EdgeRecord &record)
+    {
+        graph.AddEdge(edge);
+        edges_.push_back(record);
+    }
+
+    domain::RouteInformation TransoprtRouter::FoldRideSegments(const Router::RouteInfo &route) const
+    {
+        // the edges of a route alternate: boarding, ride segments of one bus, leaving, boarding...
+        domain::RouteInformation route_info;
+        route_info.total_time = route.weight;
+        route_info.bus_wait_time = bus_wait_time_;
+        route_info.route_found = true;
+        bool on_board = false;
+        for (const auto edge : route.edges)
+        {
+            const domain::EdgeInfo edge_info = GetEdgeInfo(edge);
+            if (edge_info.span_count > 0)
+            {
+                auto &ride = route_info.edges_info.back();
+                ride.span_count += edge_info.span_count;
+                ride.time += edge_info.time;
+                ride.stop_to = edge_info.stop_to;
+            }
+            else if (!on_board)
+            {
+                route_info.edges_info.push_back(edge_info);
+            }
+            on_board = edge_info.span_count > 0 || !on_board;
+        }
+        return route_info;
     }
 
-    graph::Edge<double> TransoprtRouter::CreateEdge(double &weight, const std::pair<const std::string_view, const domain::Bus *> &bus, size_t from, size_t to, bool it_straight)
+    graph::Edge<double> TransoprtRouter::CreateEdge(double &weight, const domain::Bus &bus, size_t from, size_t to, bool it_straight)
     {
         graph::Edge<double> edge;
-        edge.from = stops_id_.at(bus.second->stops[from].first);
-        edge.to = stops_id_.at(bus.second->stops[to].first);
+        edge.from = stops_vertex_[bus.stops[from]];
+        edge.to = stops_vertex_[bus.stops[to]];
         if (it_straight)
         {
-            weight += (transport_catalogue_.CalculateDistance(bus.second->stops[to - 1], bus.second->stops[to]) * 1.0) /
+            weight += (transport_catalogue_.CalculateDistance(bus.stops[to - 1], bus.stops[to]) * 1.0) /
                       (bus_velocity_ / 0.06);
         }
         else
         {
-            weight += (transport_catalogue_.CalculateDistance(bus.second->stops[to + 1], bus.second->stops[to]) * 1.0) /
+            weight += (transport_catalogue_.CalculateDistance(bus.stops[to + 1], bus.stops[to]) * 1.0) /
                       (bus_velocity_ / 0.06);
         }
         edge.weight = weight;
         return edge;
     }
 
-    domain::EdgeInfo TransoprtRouter::CountEdgeInfo(double weight, const std::pair<const std::string_view, const domain::Bus *> &bus, size_t from, size_t to)
+    domain::EdgeRecord TransoprtRouter::CountEdgeRecord(double weight, domain::BusId bus, size_t from, size_t to) const
     {
-        domain::EdgeInfo edge_info;
-        edge_info.name_bus = bus.first;
-        edge_info.time = weight - bus_wait_time_;
-        edge_info.stop_from = bus.second->stops[from].first;
-        edge_info.stop_to = bus.second->stops[to].first;
-        return edge_info;
+        const std::vector<domain::StopId> &stops = transport_catalogue_.GetBus(bus).stops;
+        domain::EdgeRecord record;
+        record.bus = bus;
+        record.time = weight - bus_wait_time_;
+        record.stop_from = stops[from];
+        record.stop_to = stops[to];
+        return record;
     }
 }
\ No newline at end of file
@@ -4,12 +4,32 @@
 #include "transport_catalogue.h"
 #include "json.h"
 
+#include <limits>
+#include <memory>
+
 namespace catalogue::tr_router
 {
+    enum class RouterType
+    {
+        ALL_PAIRS,
+        DIJKSTRA,
+        CONTRACTION_HIERARCHIES,
+    };
+
+    // STOP_PAIRS - stops are the only vertices, every bus links each stop of the route with every later one;
+    // RIDE_SEGMENTS - every bus direction is a chain of ride vertices boarded and left at the stop vertices
+    enum class GraphModel
+    {
+        STOP_PAIRS,
+        RIDE_SEGMENTS,
+    };
+
     class TransoprtRouter
     {
     private:
         using Graph = graph::DirectedWeightedGraph<double>;
+        using FrozenGraph = graph::CsrGraph<double>;
+        using Router = graph::RouterBase<double>;
 
     public:
         TransoprtRouter(const catalogue::TransportCatalogue &transport_catalogue, const json::Node &routing_settings);
@@ -18,39 +38,107 @@ namespace catalogue::tr_router
 
         Graph CreateGraph();
 
+        // The graph of the catalogue after an update of the catalogue the previous router is built over. The edges of the buses
+        // which have not changed are taken from the previous graph, only the rest are generated. update gets the new ids
+        // of the vertices and the edges of the previous graph
+        Graph UpdateGraph(const TransoprtRouter &previous, const FrozenGraph &previous_graph,
+                          const TransportCatalogue::Renumbering &renumbering, const domain::CatalogueChanges &changes,
+                          graph::GraphUpdate &update);
+
+        std::unique_ptr<Router> CreateRouter(const FrozenGraph &graph) const;
+
+        // The routes table of the previous graph is updated, the other routers are created again
+        std::unique_ptr<Router> UpdateRouter(const FrozenGraph &graph, const Router &previous_router, const graph::GraphUpdate &update) const;
+
         bool StopIsWorking(std::string_view name_stop) const;
 
         size_t GetStopId(std::string_view name_stop) const;
 
-        domain::EdgeInfo GetEdgeInfo(double edge) const;
+        size_t GetVertexId(domain::StopId stop) const;
+
+        size_t GetStopsCount() const;
+
+        domain::EdgeInfo GetEdgeInfo(size_t edge) const;
 
-        domain::RouteInformation FindRouteInformation(const std::optional<graph::Router<double>::RouteInfo> &route) const;
+        const domain::EdgeRecord &GetEdgeRecord(size_t edge) const;
 
-        const std::unordered_map<size_t, domain::EdgeInfo> &GetEdgesInfo() const;
+        size_t GetEdgeCount() const;
+
+        domain::RouteInformation FindRouteInformation(const std::optional<Router::RouteInfo> &route) const;
 
         double GetBusWaitTime() const;
 
-        void AddEdgeInfo(size_t id, const domain::EdgeInfo &edge_info);
+        double GetBusVelocity() const;
+
+        RouterType GetRouterType() const;
+
+        const graph::RoutesTableSettings &GetRoutesTableSettings() const;
+
+        GraphModel GetGraphModel() const;
+
+        // Indexed by edge id
+        void SetEdgeRecords(std::vector<domain::EdgeRecord> edges);
+
+        // Records laid out elsewhere, e.g. in a mapped base file; they are not copied and have to outlive the router
+        void SetEdgeRecords(const domain::EdgeRecord *edges, size_t count);
 
         void SetBusWaitTime(double bus_wait_time);
 
         void SetBusVelocity(double bus_velocity);
 
+        void SetRouterType(RouterType router_type);
+
+        void SetGraphModel(GraphModel graph_model);
+
         const catalogue::TransportCatalogue &GetTransoprtCatalogue() const;
 
     private:
         const catalogue::TransportCatalogue &transport_catalogue_;
         double bus_velocity_ = 0;
         double bus_wait_time_ = 0;
-        std::unordered_map<std::string_view, size_t> stops_id_;
-        std::unordered_map<size_t, domain::EdgeInfo> edges_info_;
+        RouterType router_type_ = RouterType::ALL_PAIRS;
+        graph::RoutesTableSettings routes_table_settings_;
+        GraphModel graph_model_ = GraphModel::STOP_PAIRS;
+        // the vertex of every stop of the catalogue, NO_VERTEX for the stops no bus passes
+        std::vector<size_t> stops_vertex_;
+        size_t working_stops_count_ = 0;
+        // indexed by edge id
+        std::vector<domain::EdgeRecord> edges_;
+        const domain::EdgeRecord *mapped_edges_ = nullptr;
+        size_t mapped_edge_count_ = 0;
+
+        static constexpr size_t NO_VERTEX = std::numeric_limits<size_t>::max();
 
         void SetStopsId();
 
-        graph::Edge<double> CreateEdge(double &weight, const std::pair<const std::string_view, const domain::Bus *> &bus,
-                                       size_t from, size_t to, bool it_straight);
+        static RouterType ReadRouterType(const json::Dict &routing_settings);
+
+        static GraphModel ReadGraphModel(const json::Dict &routing_settings);
+
+        static graph::RoutesTableSettings ReadRoutesTableSettings(const json::Dict &routing_settings);
+
+        // The ride vertices of the bus, if the graph model has them, are [first_ride_vertex, first_ride_vertex + CountRideVertices(bus))
+        void AddBusEdges(Graph &graph, size_t first_ride_vertex, domain::BusId bus_id);
+
+        static bool IsSameRoute(const domain::Bus &previous_bus, const domain::Bus &bus, const TransportCatalogue::Renumbering &renumbering);
+
+        // The edges generated again for a changed bus which come out the same as ones of its previous edges keep their place
+        // in the routes, e.g. the ones of a route which has lost its last stop
+        void KeepSameEdges(const TransoprtRouter &previous, const FrozenGraph &previous_graph, size_t first_previous_edge,
+                           size_t previous_edge_count, const Graph &graph, size_t first_edge, graph::GraphUpdate &update) const;
+
+        size_t CountVertices(const std::vector<domain::BusId> &buses) const;
+
+        size_t CountRideVertices(const domain::Bus &bus) const;
+
+        void AddRideSegments(Graph &graph, size_t first_vertex, domain::BusId bus, const std::vector<domain::StopId> &stops);
+
+        void AddEdge(Graph &graph, const graph::Edge<double> &edge, const domain::EdgeRecord &record);
+
+        domain::RouteInformation FoldRideSegments(const Router::RouteInfo &route) const;
+
+        graph::Edge<double> CreateEdge(double &weight, const domain::Bus &bus, size_t from, size_t to, bool it_straight);
 
-        domain::EdgeInfo CountEdgeInfo(double weight, const std::pair<const std::string_view, const domain::Bus *> &bus,
-                                       size_t from, size_t to);
+        domain::EdgeRecord CountEdgeRecord(double weight, domain::BusId bus, size_t from, size_t to) const;
     };
 }
\ No newline at end of file